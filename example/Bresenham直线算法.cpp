@@ -57,17 +57,20 @@ public:
         }
     }
 
-    auto doLine(const Point2& p1, const Point2& p2) {
-        bresenhamLine({static_cast<int>(p1.x), static_cast<int>(p1.y)}, constants::red, {static_cast<int>(p2.x), static_cast<int>(p2.y)}, constants::green);
+    // 端点为点击所在像素的定点坐标, 之后的步进全部是整数运算
+    auto doLine(const PointFixed2& p1, const PointFixed2& p2) {
+        bresenhamLine(PointFixed2ToInt(p1), constants::red, PointFixed2ToInt(p2), constants::green);
     }
 
     auto impl_paint() -> void override {
         if (auto [ok, p] = getClickedTexturePos(); ok) {
+            // 先取所在的像素再转换: 直接转换时 599.999 会舍入到 600, 超出画布
+            auto pixel = Point2(std::floor(p.x), std::floor(p.y)).cast<Fixed>();
             if (m_begin_ok) {
-                doLine(m_begin, p);
+                doLine(m_begin, pixel);
             }
             else {
-                m_begin = p;
+                m_begin = pixel;
             }
             m_begin_ok = !m_begin_ok;
         }
@@ -83,8 +86,12 @@ public:
         });
     }
 
-    Point2 m_begin;
-    bool   m_begin_ok = false;
+    auto lazyInit() const -> bool override {
+        return true;
+    }
+
+    PointFixed2 m_begin;
+    bool        m_begin_ok = false;
 };
 TG_QUICK_WINDOW_REGISTER_2
 }   // namespace
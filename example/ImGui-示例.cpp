@@ -7,6 +7,11 @@ using namespace tg;
 namespace {
 class Impl : public ui::Window {
 public:
+    auto init() -> void override {
+        // 示例窗口中有动画, 需要持续绘制
+        setAnimating(true);
+    }
+
     auto paint() -> void override {
         ImGui::ShowDemoWindow();
     }
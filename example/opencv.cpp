@@ -11,9 +11,12 @@ public:
     auto init() -> void override {
         spdlog::info("示例初始化成功: {}", CV_VERSION);
 
-        cv::Mat image = cv::Mat::zeros(100, 100, CV_8UC3);
-        cv::rectangle(image, cv::Point(10, 10), cv::Point(90, 90), cv::Scalar(255, 0, 0), 2);
-        cv::imwrite("output_image.jpg", image);
+        // 写文件放到后台
+        initInBackground([]() {
+            cv::Mat image = cv::Mat::zeros(100, 100, CV_8UC3);
+            cv::rectangle(image, cv::Point(10, 10), cv::Point(90, 90), cv::Scalar(255, 0, 0), 2);
+            cv::imwrite("output_image.jpg", image);
+        });
     }
 };
 TG_QUICK_WINDOW_REGISTER_2
@@ -0,0 +1,122 @@
+#include <tg/parallel.h>
+#include <tg/render/PointCloudRenderer.h>
+#include <tg/ui/FixedCanvas2D.h>
+
+#include <imgui.h>
+#include <random>
+
+using namespace tg;
+
+/*
+点云渲染
+
+生成一片起伏的地形点云, 左键拖动旋转, 滚轮缩放.
+八叉树 LOD 限制每帧绘制的点数, 点数可以在配置文件中修改 (5000 万点约占用 600 MB 内存).
+*/
+
+namespace {
+class Impl : public ui::FixedCanvas2D {
+public:
+    static constexpr size_t k_default_points = 2'000'000;
+
+    auto generate(size_t count) {
+        std::vector<Point3> points(count);
+        constexpr size_t    k_chunk = 1 << 16;
+        // 每块使用独立的随机数种子, 结果与线程数无关
+        parallelFor(0, count, k_chunk, [&](size_t b, size_t e) {
+            std::mt19937                          rng(static_cast<uint32_t>(b / k_chunk));
+            std::uniform_real_distribution<float> dist(-500.F, 500.F);
+            std::normal_distribution<float>       noise(0.F, 0.5F);
+            for (auto i = b; i < e; i++) {
+                auto x    = dist(rng);
+                auto z    = dist(rng);
+                auto y    = 40.F * std::sin(x * 0.01F) * std::cos(z * 0.013F) + 15.F * std::sin(x * 0.05F + z * 0.03F) + noise(rng);
+                points[i] = Point3(x, y, z);
+            }
+        });
+        auto start = std::chrono::steady_clock::now();
+        m_renderer.setPoints(std::move(points));
+        spdlog::info("点云八叉树: {} 点, {} 节点, {}", count, m_renderer.octree().nodes().size(), formatReadableDuration(std::chrono::steady_clock::now() - start));
+        m_camera.fit(m_renderer.octree().bounds());
+        m_camera.m_distance *= 0.6F;
+        m_changed = true;
+    }
+
+    auto memoryUsage(ui::MemoryUsage& usage) const -> void override {
+        FixedCanvas2D::memoryUsage(usage);
+        usage.add("点云", m_renderer.octree().memoryBytes());
+        usage.add("临时缓冲", m_renderer.scratchBytes());
+    }
+
+    auto trimMemory() -> size_t override {
+        return FixedCanvas2D::trimMemory() + m_renderer.trim();
+    }
+
+    // 光栅化在线程池中与其它窗口并行, impl_paint 只上传纹理和绘制界面
+    auto prepare() -> void override {
+        if (m_changed) {
+            m_stats   = m_renderer.render(mutableImage(), m_camera, constants::black);
+            m_changed = false;
+        }
+    }
+
+    auto impl_paint() -> void override {
+        auto budget = static_cast<int>(m_renderer.m_point_budget / 1000);
+        if (ImGui::SliderInt("每帧点数上限 (千)", &budget, 100, 20000)) {
+            m_renderer.m_point_budget = static_cast<size_t>(budget) * 1000;
+            m_changed                 = true;
+        }
+        ImGui::Text("总点数 %zu, 绘制 %zu, 节点 %zu", m_stats.m_total_points, m_stats.m_drawn_points, m_stats.m_nodes);
+        ImGui::Text("LOD %s, 投影 %s, 光栅化 %s", formatReadableDuration(std::chrono::nanoseconds(m_stats.m_select_ns)).c_str(), formatReadableDuration(std::chrono::nanoseconds(m_stats.m_project_ns)).c_str(), formatReadableDuration(std::chrono::nanoseconds(m_stats.m_raster_ns)).c_str());
+        ui::FixedCanvas2D::impl_paint();
+
+        if (ImGui::IsItemHovered()) {
+            auto& io = ImGui::GetIO();
+            if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+                m_camera.rotate(io.MouseDelta.x, io.MouseDelta.y);
+                m_changed = true;
+            }
+            if (io.MouseWheel != 0) {
+                m_camera.zoom(std::pow(0.9F, io.MouseWheel));
+                m_changed = true;
+            }
+        }
+        if (m_changed) {
+            requestRedraw();
+        }
+    }
+
+    auto init() -> void override {
+        FixedCanvas2D::init();
+        resize(800, 600);
+
+        auto count = k_default_points;
+        if (auto config = readConfig(); config.contains("点数")) {
+            count = config["点数"].get<size_t>();
+        }
+        else {
+            writeConfig("点数", count);
+        }
+        // 生成点云和建八叉树需要数百毫秒, 放到后台, 不阻塞其它窗口
+        initInBackground([this, count]() { generate(count); });
+
+        registerEvent("重置相机", [this]() {
+            m_camera.fit(m_renderer.octree().bounds());
+            m_camera.m_distance *= 0.6F;
+            m_changed = true;
+            requestRedraw();
+        });
+    }
+
+    // 生成点云占用数百 MB 内存, 窗口可见时才开始
+    auto lazyInit() const -> bool override {
+        return true;
+    }
+
+    render::PointCloudRenderer        m_renderer;
+    render::OrbitCamera               m_camera;
+    render::PointCloudRenderer::Stats m_stats;
+    bool                              m_changed = true;
+};
+TG_QUICK_WINDOW_REGISTER_2
+}   // namespace
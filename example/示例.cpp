@@ -14,6 +14,10 @@ public:
         });
     }
 
+    auto lazyInit() const -> bool override {
+        return true;
+    }
+
     auto impl_paint() -> void override {
         ImGui::Text("Hello World!");
         ImGui::Text("你好，世界！");
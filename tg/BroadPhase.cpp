@@ -0,0 +1,175 @@
+#include <tg/BroadPhase.h>
+#include <tg/parallel.h>
+
+namespace tg {
+namespace {
+// 值相同时 min 端点排在 max 端点前面, 接触的盒子算作相交
+auto endpointLess(float value, bool is_max, float other_value, bool other_is_max) -> bool {
+    return value < other_value || (value == other_value && !is_max && other_is_max);
+}
+}   // namespace
+
+auto SweepAndPrune::update(std::span<const Rect> rects) -> void {
+    auto count = rects.size();
+    if (count > std::numeric_limits<uint32_t>::max()) {
+        throw tg_exception("too many rects: {}", count);
+    }
+    auto resized = count != m_min.size();
+    m_min.resize(count);
+    m_max.resize(count);
+    parallelFor(0, count, 1 << 14, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            std::tie(m_min[i], m_max[i]) = rects[i].bounds();
+        }
+    });
+
+    if (resized) {
+        m_endpoints.clear();
+        m_endpoints.reserve(count * 2);
+        for (uint32_t i = 0; i < count; i++) {
+            m_endpoints.push_back({0, i, false, 0, 0});
+            m_endpoints.push_back({0, i, true, 0, 0});
+        }
+    }
+    for (auto& e : m_endpoints) {
+        e.m_value = e.m_is_max ? m_max[e.m_box].x : m_min[e.m_box].x;
+        e.m_min_y = m_min[e.m_box].y;
+        e.m_max_y = m_max[e.m_box].y;
+    }
+    sortEndpoints(resized);
+    buildStrips();
+    parallelFor(0, m_strip_candidates.size(), 1, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            sweepStrip(i, m_strip_candidates[i]);
+        }
+    });
+    m_candidates.clear();
+    for (const auto& i : m_strip_candidates) {
+        m_candidates.insert(m_candidates.end(), i.begin(), i.end());
+    }
+    narrowPhase(rects);
+}
+
+auto SweepAndPrune::sortEndpoints(bool full) -> void {
+    auto less = [](const Endpoint& a, const Endpoint& b) {
+        return endpointLess(a.m_value, a.m_is_max, b.m_value, b.m_is_max);
+    };
+    m_swaps = 0;
+    if (!full) {
+        // 插入排序, 与上一帧相比只移动了少量位置时接近线性
+        auto limit = m_endpoints.size() * k_max_swaps_per_endpoint;
+        for (size_t i = 1; i < m_endpoints.size() && m_swaps <= limit; i++) {
+            auto e = m_endpoints[i];
+            auto j = i;
+            for (; j > 0 && less(e, m_endpoints[j - 1]); j--) {
+                m_endpoints[j] = m_endpoints[j - 1];
+            }
+            m_endpoints[j] = e;
+            m_swaps += i - j;
+        }
+        full = m_swaps > limit;
+    }
+    if (full) {
+        std::ranges::sort(m_endpoints, less);
+    }
+}
+
+auto SweepAndPrune::buildStrips() -> void {
+    auto count = m_min.size();
+    if (count == 0) {
+        m_strip_candidates.clear();
+        return;
+    }
+    auto  min_y  = m_min[0].y;
+    auto  max_y  = m_max[0].y;
+    float height = 0;
+    for (size_t i = 0; i < count; i++) {
+        min_y   = std::min(min_y, m_min[i].y);
+        max_y   = std::max(max_y, m_max[i].y);
+        height += m_max[i].y - m_min[i].y;
+    }
+    height        /= static_cast<float>(count);
+    size_t strips  = 1;
+    if (height > 0 && max_y > min_y) {
+        strips = std::clamp<size_t>(static_cast<size_t>((max_y - min_y) / (height * k_strip_height)), 1, std::max<size_t>(count / 8, 1));
+    }
+    m_strip_min_y = min_y;
+    m_strip_scale = static_cast<float>(strips) / std::max(max_y - min_y, std::numeric_limits<float>::min());
+    m_strip_candidates.resize(strips);
+
+    // 按全局 x 顺序把端点分到盒子覆盖的每个条带, 条带内自然有序
+    m_strip_offsets.assign(strips + 1, 0);
+    for (const auto& e : m_endpoints) {
+        for (auto i = strip(e.m_min_y); i <= strip(e.m_max_y); i++) {
+            m_strip_offsets[i + 1]++;
+        }
+    }
+    for (size_t i = 0; i < strips; i++) {
+        m_strip_offsets[i + 1] += m_strip_offsets[i];
+    }
+    m_strip_endpoints.resize(m_strip_offsets.back());
+    std::vector<size_t> cursor(m_strip_offsets.begin(), m_strip_offsets.end() - 1);
+    for (const auto& e : m_endpoints) {
+        for (auto i = strip(e.m_min_y); i <= strip(e.m_max_y); i++) {
+            m_strip_endpoints[cursor[i]++] = e;
+        }
+    }
+}
+
+auto SweepAndPrune::sweepStrip(size_t s, std::vector<Pair>& out) const -> void {
+    out.clear();
+    std::vector<uint32_t> active;         // x 区间包含当前位置的盒子
+    std::vector<float>    active_min_y;   // 与 active 对应, 连续存放便于比较
+    std::vector<float>    active_max_y;
+    for (auto k = m_strip_offsets[s]; k < m_strip_offsets[s + 1]; k++) {
+        const auto& e   = m_strip_endpoints[k];
+        auto        box = e.m_box;
+        if (e.m_is_max) {
+            auto i = static_cast<size_t>(std::ranges::find(active, box) - active.begin());
+            std::swap(active[i], active.back());
+            std::swap(active_min_y[i], active_min_y.back());
+            std::swap(active_max_y[i], active_max_y.back());
+            active.pop_back();
+            active_min_y.pop_back();
+            active_max_y.pop_back();
+            continue;
+        }
+        auto min_y = e.m_min_y;
+        auto max_y = e.m_max_y;
+        for (size_t i = 0; i < active.size(); i++) {
+            // 一对盒子可能同时出现在几个条带中, 只在 y 重叠区间的下端所在的条带中报告
+            if (active_min_y[i] <= max_y && min_y <= active_max_y[i] && strip(std::max(min_y, active_min_y[i])) == s) {
+                auto other = active[i];
+                out.emplace_back(std::min(box, other), std::max(box, other));
+            }
+        }
+        active.push_back(box);
+        active_min_y.push_back(min_y);
+        active_max_y.push_back(max_y);
+    }
+}
+
+auto SweepAndPrune::narrowPhase(std::span<const Rect> rects) -> void {
+    m_hit.resize(m_candidates.size());
+    parallelFor(0, m_candidates.size(), 1 << 12, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            auto [first, second] = m_candidates[i];
+            m_hit[i]             = rects[first].overlaps(rects[second]) ? 1 : 0;
+        }
+    });
+
+    // 新的相交列表与上一帧的比较得到增删
+    std::swap(m_pairs, m_previous);
+    m_pairs.clear();
+    for (size_t i = 0; i < m_candidates.size(); i++) {
+        if (m_hit[i] != 0) {
+            m_pairs.push_back(m_candidates[i]);
+        }
+    }
+    std::ranges::sort(m_pairs);
+    m_added.clear();
+    m_removed.clear();
+    std::ranges::set_difference(m_pairs, m_previous, std::back_inserter(m_added));
+    std::ranges::set_difference(m_previous, m_pairs, std::back_inserter(m_removed));
+}
+}   // namespace tg
@@ -0,0 +1,86 @@
+#pragma once
+#include <tg/Rect.h>
+
+namespace tg {
+// 一组移动的 Rect 之间的碰撞检测.
+// 粗测: 包围盒在 x 轴上的端点保持有序 (sweep and prune). 每帧只移动了少量位置时插入排序接近线性.
+// 只沿一个轴扫描时, 盒子分布在二维平面上会使 x 区间重叠的盒子数随规模增长, 所以再按 y 分成若干水平条带,
+// 每个条带按 x 顺序独立扫描 (并行), 只在 x 区间重叠的盒子之间比较 y 区间, 得到包围盒相交的候选对.
+// 细测: 对候选对做分离轴测试, 同样并行执行.
+class SweepAndPrune {
+public:
+    using Pair = std::pair<uint32_t, uint32_t>;   // 下标, first < second
+
+    // 插入排序的交换次数超过端点数的这个倍数时 (帧间变化太大) 改为完整排序
+    static constexpr size_t k_max_swaps_per_endpoint = 32;
+
+    // 条带高度为盒子平均高度的倍数
+    static constexpr float k_strip_height = 4;
+
+    // 更新第 i 个盒子为 rects[i]. 数量变化 (或第一次调用) 时完整排序
+    auto update(std::span<const Rect> rects) -> void;
+
+    // 相交的矩形对, 升序
+    auto pairs() const -> std::span<const Pair> {
+        return m_pairs;
+    }
+
+    // 与上一次 update 相比新增的和不再相交的矩形对, 升序
+    auto added() const -> std::span<const Pair> {
+        return m_added;
+    }
+
+    auto removed() const -> std::span<const Pair> {
+        return m_removed;
+    }
+
+    // 包围盒相交的候选对数量
+    auto candidateCount() const {
+        return m_candidates.size();
+    }
+
+    // 上一次 update 中插入排序的交换次数, 用于观察帧间连贯性
+    auto swapCount() const {
+        return m_swaps;
+    }
+
+    auto stripCount() const {
+        return m_strip_candidates.size();
+    }
+
+private:
+    struct Endpoint {
+        float    m_value;
+        uint32_t m_box;
+        bool     m_is_max;
+        float    m_min_y;   // 盒子的 y 区间, 与端点放在一起, 分条带和扫描时不需要随机访问
+        float    m_max_y;
+    };
+
+    auto sortEndpoints(bool full) -> void;
+    auto buildStrips() -> void;
+    auto sweepStrip(size_t strip, std::vector<Pair>& out) const -> void;
+    auto narrowPhase(std::span<const Rect> rects) -> void;
+
+    auto strip(float y) const -> size_t {
+        auto count = m_strip_candidates.size();
+        return std::min(static_cast<size_t>(std::max((y - m_strip_min_y) * m_strip_scale, 0.F)), count - 1);
+    }
+
+    std::vector<Point2>            m_min;               // 每个盒子的包围盒
+    std::vector<Point2>            m_max;
+    std::vector<Endpoint>          m_endpoints;         // x 轴上有序的端点
+    float                          m_strip_min_y = 0;
+    float                          m_strip_scale = 0;   // 1 / 条带高度
+    std::vector<size_t>            m_strip_offsets;     // 第 i 个条带的端点为 [m_strip_offsets[i], m_strip_offsets[i + 1])
+    std::vector<Endpoint>          m_strip_endpoints;   // 每个条带内按 x 有序
+    std::vector<std::vector<Pair>> m_strip_candidates;
+    std::vector<Pair>              m_candidates;
+    std::vector<uint8_t>           m_hit;
+    std::vector<Pair>              m_pairs;
+    std::vector<Pair>              m_previous;
+    std::vector<Pair>              m_added;
+    std::vector<Pair>              m_removed;
+    size_t                         m_swaps = 0;
+};
+}   // namespace tg
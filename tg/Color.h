@@ -1,4 +1,5 @@
 #pragma once
+#include <tg/ElementWise.h>
 #include <tg/utils.h>
 
 #include <format>
@@ -12,6 +13,9 @@ public:
     value_t g         = 0;
     value_t b         = 0;
 
+    // 各分量的成员指针, 运算符通过 detail::zip 逐分量展开
+    static constexpr std::array k_members{&Color::r, &Color::g, &Color::b};
+
     constexpr Color() = default;
 
     constexpr Color(value_t r, value_t g, value_t b)
@@ -23,71 +27,59 @@ public:
           b(static_cast<value_t>(b) / static_cast<value_t>(std::numeric_limits<uint8_t>::max())) {}
 
     constexpr auto operator+=(const Color& right) {
-        r += right.r;
-        g += right.g;
-        b += right.b;
+        *this = *this + right;
     }
 
     constexpr auto operator-=(const Color& right) {
-        r -= right.r;
-        g -= right.g;
-        b -= right.b;
+        *this = *this - right;
     }
 
     constexpr auto operator*=(const Color& right) {
-        r *= right.r;
-        g *= right.g;
-        b *= right.b;
+        *this = *this * right;
     }
 
     constexpr auto operator*=(const value_t& right) {
-        r *= right;
-        g *= right;
-        b *= right;
+        *this = *this * right;
     }
 
     constexpr auto operator/=(const Color& right) {
-        r /= right.r;
-        g /= right.g;
-        b /= right.b;
+        *this = *this / right;
     }
 
     constexpr auto operator/=(const value_t& right) {
-        r /= right;
-        g /= right;
-        b /= right;
+        *this = *this / right;
     }
 
     friend constexpr auto operator==(const Color& left, const Color& right) {
-        return equalF(left.r, right.r) && equalF(left.g, right.g) && equalF(left.b, right.b);
+        return detail::allOf([](value_t a, value_t b) { return equalF(a, b); }, left, right);
     }
 
     friend constexpr auto operator!=(const Color& left, const Color& right) {
         return !(left == right);
     }
 
-    friend constexpr auto operator+(const Color& left, const Color& right) {
-        return Color(left.r + right.r, left.g + right.g, left.b + right.b);
+    friend constexpr auto operator+(const Color& left, const Color& right) -> Color {
+        return detail::zip<Color>(std::plus<>{}, left, right);
     }
 
-    friend constexpr auto operator-(const Color& left, const Color& right) {
-        return Color(left.r - right.r, left.g - right.g, left.b - right.b);
+    friend constexpr auto operator-(const Color& left, const Color& right) -> Color {
+        return detail::zip<Color>(std::minus<>{}, left, right);
     }
 
-    friend constexpr auto operator*(const Color& left, const Color& right) {
-        return Color(left.r * right.r, left.g * right.g, left.b * right.b);
+    friend constexpr auto operator*(const Color& left, const Color& right) -> Color {
+        return detail::zip<Color>(std::multiplies<>{}, left, right);
     }
 
-    friend constexpr auto operator*(const Color& left, const value_t& right) {
-        return Color(left.r * right, left.g * right, left.b * right);
+    friend constexpr auto operator*(const Color& left, const value_t& right) -> Color {
+        return detail::zip<Color>(std::multiplies<>{}, left, right);
     }
 
-    friend constexpr auto operator/(const Color& left, const Color& right) {
-        return Color(left.r / right.r, left.g / right.g, left.b / right.b);
+    friend constexpr auto operator/(const Color& left, const Color& right) -> Color {
+        return detail::zip<Color>(std::divides<>{}, left, right);
     }
 
-    friend constexpr auto operator/(const Color& left, const value_t& right) {
-        return Color(left.r / right, left.g / right, left.b / right);
+    friend constexpr auto operator/(const Color& left, const value_t& right) -> Color {
+        return detail::zip<Color>(std::divides<>{}, left, right);
     }
 
     // 提取8位颜色分量
@@ -124,6 +116,25 @@ public:
     }
 };
 
+// 8 位颜色, 分量顺序与 opencv 的 BGR(A) 像素一致, 用于批量绘制时预先转换, 避免逐点从 float 转换
+class Color32 {
+public:
+    uint8_t b = 0;
+    uint8_t g = 0;
+    uint8_t r = 0;
+    uint8_t a = std::numeric_limits<uint8_t>::max();
+
+    constexpr Color32() = default;
+
+    constexpr Color32(uint8_t r, uint8_t g, uint8_t b, uint8_t a = std::numeric_limits<uint8_t>::max())
+        : b(b), g(g), r(r), a(a) {}
+
+    constexpr Color32(const Color& color)   // NOLINT
+        : Color32(color.get_r8(), color.get_g8(), color.get_b8()) {}
+
+    friend constexpr auto operator==(const Color32& left, const Color32& right) -> bool = default;
+};
+
 namespace constants {
 constexpr auto black   = Color::from_uint8(0, 0, 0);         // 黑色
 constexpr auto white   = Color::from_uint8(255, 255, 255);   // 白色
@@ -0,0 +1,223 @@
+#include <tg/CompressedPoints.h>
+#include <tg/cpu.h>
+
+namespace tg {
+namespace {
+static_assert(sizeof(Point3) == sizeof(float) * 3 && std::is_standard_layout_v<Point3>, "Point3 is decoded as packed floats");
+
+// Point3 数组按 x, y, z 交错的 float 数组访问
+auto asFloats(std::span<Point3> points) {
+    return reinterpret_cast<float*>(points.data());   // NOLINT
+}
+
+auto checkRange(size_t first, size_t count, size_t size) {
+    if (first > size || count > size - first) {
+        throw tg_exception("decode out of range: [{}, {}) size {}", first, first + count, size);
+    }
+}
+
+#if defined(TG_X86)
+// 一次转换 8 个分量, 返回转换的分量数, 剩余的由标量代码处理
+TG_TARGET_AVX2 auto halfToFloatF16C(const uint16_t* src, float* dst, size_t n) -> size_t {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));   // NOLINT
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+
+// 一次解码 8 个点, 返回解码的点数
+TG_TARGET_AVX2 auto dequantizeAvx2(const uint16_t* src, float* dst, size_t n, const Point3& origin, const Point3& scale) -> size_t {
+    // 8 个点 = 24 个分量 = 3 个向量, x, y, z 在向量中的位置以 3 个向量为周期轮换
+    std::array<std::array<float, 8>, 3> scale_pattern{};
+    std::array<std::array<float, 8>, 3> origin_pattern{};
+    for (size_t k = 0; k < 3; k++) {
+        for (size_t j = 0; j < 8; j++) {
+            scale_pattern[k][j]  = scale[(k * 8 + j) % 3];
+            origin_pattern[k][j] = origin[(k * 8 + j) % 3];
+        }
+    }
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t k = 0; k < 3; k++) {
+            auto q = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + k * 8)));   // NOLINT
+            _mm256_storeu_ps(dst + i * 3 + k * 8, _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(q), _mm256_loadu_ps(scale_pattern[k].data())), _mm256_loadu_ps(origin_pattern[k].data())));
+        }
+    }
+    return i;
+}
+#endif
+}   // namespace
+
+auto PointsF16::append(std::span<const Point3> points) -> void {
+    m_data.reserve(m_data.size() + points.size() * 3);
+    for (const auto& p : points) {
+        push_back(p);
+    }
+}
+
+auto PointsF16::decode(size_t first, std::span<Point3> out) const -> void {
+    checkRange(first, out.size(), size());
+    const auto* src = m_data.data() + first * 3;
+    auto*       dst = asFloats(out);
+    size_t      n   = out.size() * 3;
+    size_t      i   = 0;
+#if defined(TG_X86)
+    if (cpu::hasAvx2()) {
+        i = halfToFloatF16C(src, dst, n);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = Half::toFloat(src[i]);
+    }
+}
+
+auto PointsF16::decode() const -> std::vector<Point3> {
+    std::vector<Point3> res(size());
+    decode(0, res);
+    return res;
+}
+
+auto PointsF16::bounds() const -> Bounds3 {
+    Bounds3                 res;
+    std::array<Point3, 256> buffer;
+    for (size_t i = 0; i < size(); i += buffer.size()) {
+        auto n = std::min(buffer.size(), size() - i);
+        decode(i, std::span(buffer).first(n));
+        for (size_t j = 0; j < n; j++) {
+            res.expand(buffer[j]);
+        }
+    }
+    return res;
+}
+
+auto PointsF16::transform(const Point3& scale, const Point3& offset) -> void {
+    for (size_t i = 0; i < m_data.size(); i++) {
+        auto axis = i % 3;
+        m_data[i] = Half::fromFloat(Half::toFloat(m_data[i]) * scale[axis] + offset[axis]);
+    }
+}
+
+auto PointsQuantized::append(std::span<const Point3> points) -> void {
+    if (m_data.size() / 3 % k_block_size != 0) {
+        throw tg_exception("PointsQuantized append after flush");
+    }
+    while (!points.empty()) {
+        // 先补满未满的块, 满一块才量化
+        if (!m_pending.empty() || points.size() < k_block_size) {
+            auto n = std::min(points.size(), k_block_size - m_pending.size());
+            m_pending.insert(m_pending.end(), points.begin(), points.begin() + static_cast<ptrdiff_t>(n));
+            points = points.subspan(n);
+            if (m_pending.size() == k_block_size) {
+                encodeBlock(m_pending);
+                m_pending.clear();
+            }
+            continue;
+        }
+        encodeBlock(points.first(k_block_size));
+        points = points.subspan(k_block_size);
+    }
+}
+
+auto PointsQuantized::flush() -> void {
+    if (!m_pending.empty()) {
+        encodeBlock(m_pending);
+        m_pending.clear();
+        m_pending.shrink_to_fit();
+    }
+}
+
+auto PointsQuantized::encodeBlock(std::span<const Point3> points) -> void {
+    Bounds3 b;
+    for (const auto& p : points) {
+        b.expand(p);
+    }
+    Block block{
+        .m_origin = b.m_min,
+        .m_scale  = detail::zip<Point3>([](float lo, float hi) { return (hi - lo) / static_cast<float>(k_max_q); }, b.m_min, b.m_max),
+    };
+    m_blocks.push_back(block);
+    m_data.reserve(m_data.size() + points.size() * 3);
+
+    for (const auto& p : points) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            auto scale = block.m_scale[axis];
+            auto q     = scale > 0 ? std::lround((p[axis] - block.m_origin[axis]) / scale) : 0L;
+            m_data.push_back(static_cast<uint16_t>(std::clamp<long>(q, 0, k_max_q)));
+        }
+    }
+}
+
+auto PointsQuantized::decode(size_t first, std::span<Point3> out) const -> void {
+    checkRange(first, out.size(), size());
+    auto* dst     = asFloats(out);
+    auto  encoded = m_data.size() / 3;
+    for (size_t i = 0; i < out.size();) {
+        auto index = first + i;
+        if (index >= encoded) {
+            std::ranges::copy(std::span(m_pending).subspan(index - encoded, out.size() - i), out.begin() + static_cast<ptrdiff_t>(i));
+            break;
+        }
+        const auto& block = m_blocks[index / k_block_size];
+        auto        n     = std::min({out.size() - i, k_block_size - index % k_block_size, encoded - index});   // 不跨块
+        const auto* src   = m_data.data() + index * 3;
+        auto*       d     = dst + i * 3;
+        size_t      j     = 0;
+#if defined(TG_X86)
+        if (cpu::hasAvx2()) {
+            j = dequantizeAvx2(src, d, n, block.m_origin, block.m_scale);
+        }
+#endif
+        for (; j < n; j++) {
+            for (size_t axis = 0; axis < 3; axis++) {
+                d[j * 3 + axis] = block.m_origin[axis] + static_cast<float>(src[j * 3 + axis]) * block.m_scale[axis];
+            }
+        }
+        i += n;
+    }
+}
+
+auto PointsQuantized::decode() const -> std::vector<Point3> {
+    std::vector<Point3> res(size());
+    decode(0, res);
+    return res;
+}
+
+auto PointsQuantized::blockBounds(size_t i) const -> Bounds3 {
+    const auto& block = m_blocks[i];
+    Bounds3     res;
+    res.expand(block.m_origin);
+    res.expand(block.m_origin + block.m_scale * static_cast<float>(k_max_q));
+    return res;
+}
+
+auto PointsQuantized::bounds() const -> Bounds3 {
+    Bounds3 res;
+    for (size_t i = 0; i < m_blocks.size(); i++) {
+        res.expand(blockBounds(i));
+    }
+    for (const auto& p : m_pending) {
+        res.expand(p);
+    }
+    return res;
+}
+
+auto PointsQuantized::transform(const Point3& scale, const Point3& offset) -> void {
+    for (auto& block : m_blocks) {
+        block.m_origin = detail::zip<Point3>([](float o, float s, float t) { return o * s + t; }, block.m_origin, scale, offset);
+        block.m_scale  = detail::zip<Point3>(std::multiplies<>{}, block.m_scale, scale);
+    }
+    for (auto& p : m_pending) {
+        p = detail::zip<Point3>([](float v, float s, float t) { return v * s + t; }, p, scale, offset);
+    }
+}
+
+auto PointsQuantized::maxError() const -> Point3 {
+    Point3 res;
+    for (const auto& block : m_blocks) {
+        res = detail::zip<Point3>([](float e, float s) { return std::max(e, std::abs(s) / 2); }, res, block.m_scale);
+    }
+    return res;
+}
+}   // namespace tg
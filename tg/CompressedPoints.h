@@ -0,0 +1,211 @@
+#pragma once
+#include <tg/Point.h>
+
+#include <bit>
+#include <span>
+
+namespace tg {
+// 半精度浮点数 (IEEE 754 binary16), 转换时舍入到最近的偶数
+class Half {
+public:
+    static constexpr auto fromFloat(float v) -> uint16_t {
+        auto f    = std::bit_cast<uint32_t>(v);
+        auto sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+        auto abs  = f & 0x7fffffff;
+        if (abs >= 0x7f800000) {   // inf, nan
+            return sign | (abs > 0x7f800000 ? 0x7e00 : 0x7c00);
+        }
+        if (abs >= 0x477ff000) {   // 超出范围, 舍入为 inf
+            return sign | 0x7c00;
+        }
+        if (abs < 0x38800000) {   // 非规格化数, 借助浮点加法完成舍入
+            constexpr auto k_magic = 126U << 23;
+            auto           res     = std::bit_cast<uint32_t>(std::bit_cast<float>(abs) + std::bit_cast<float>(k_magic)) - k_magic;
+            return sign | static_cast<uint16_t>(res);
+        }
+        auto odd = (abs >> 13) & 1;
+        abs += ((15U - 127U) << 23) + 0xfff + odd;
+        return sign | static_cast<uint16_t>(abs >> 13);
+    }
+
+    static constexpr auto toFloat(uint16_t h) -> float {
+        constexpr auto k_exp = 0x7c00U << 13;
+        auto           bits  = (h & 0x7fffU) << 13;
+        auto           exp   = bits & k_exp;
+        bits += (127U - 15U) << 23;
+        if (exp == k_exp) {   // inf, nan
+            bits += (128U - 16U) << 23;
+        }
+        else if (exp == 0) {   // 非规格化数
+            bits += 1U << 23;
+            bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(113U << 23));
+        }
+        return std::bit_cast<float>(bits | ((h & 0x8000U) << 16));
+    }
+};
+
+// 轴对齐包围盒
+class Bounds3 {
+public:
+    Point3 m_min{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    Point3 m_max{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+    auto empty() const {
+        return m_min.x > m_max.x;
+    }
+
+    auto expand(const Point3& p) -> void {
+        m_min = detail::zip<Point3>([](float a, float b) { return std::min(a, b); }, m_min, p);
+        m_max = detail::zip<Point3>([](float a, float b) { return std::max(a, b); }, m_max, p);
+    }
+
+    auto expand(const Bounds3& b) -> void {
+        if (!b.empty()) {
+            expand(b.m_min);
+            expand(b.m_max);
+        }
+    }
+};
+
+// 半精度点集, 每个点 6 字节 (Point3 为 12 字节).
+// 有效数字约 11 位, 相对误差不超过 2^-11, 适合坐标范围较小或已经平移到原点附近的数据.
+class PointsF16 {
+public:
+    PointsF16() = default;
+
+    explicit PointsF16(std::span<const Point3> points) {
+        append(points);
+    }
+
+    auto size() const {
+        return m_data.size() / 3;
+    }
+
+    auto empty() const {
+        return m_data.empty();
+    }
+
+    auto memoryBytes() const {
+        return m_data.capacity() * sizeof(uint16_t);
+    }
+
+    auto operator[](size_t i) const {
+        return Point3(Half::toFloat(m_data[i * 3]), Half::toFloat(m_data[i * 3 + 1]), Half::toFloat(m_data[i * 3 + 2]));
+    }
+
+    auto push_back(const Point3& p) -> void {
+        m_data.push_back(Half::fromFloat(p.x));
+        m_data.push_back(Half::fromFloat(p.y));
+        m_data.push_back(Half::fromFloat(p.z));
+    }
+
+    auto reserve(size_t n) -> void {
+        m_data.reserve(n * 3);
+    }
+
+    auto clear() -> void {
+        m_data.clear();
+    }
+
+    auto append(std::span<const Point3> points) -> void;
+
+    // 解码 [first, first + out.size()) 的点, 支持 F16C 时一次转换 8 个分量
+    auto decode(size_t first, std::span<Point3> out) const -> void;
+
+    auto decode() const -> std::vector<Point3>;
+
+    auto bounds() const -> Bounds3;
+
+    // p * scale + offset, 逐分量运算后重新舍入
+    auto transform(const Point3& scale, const Point3& offset) -> void;
+
+private:
+    std::vector<uint16_t> m_data;   // x, y, z 交错存储
+};
+
+// 16 位量化点集, 每 k_block_size 个点一块, 块内保存原点和各轴步长:
+// p = origin + q * scale, q 为 0~65535 的整数.
+// 每个点 6 字节 (另外每块 24 字节), 每个轴的误差为 scale / 2 (另加 float 的舍入误差),
+// 即块内该轴坐标范围的 1/131070.
+class PointsQuantized {
+public:
+    static constexpr size_t   k_block_size = 1024;
+    static constexpr uint32_t k_max_q      = std::numeric_limits<uint16_t>::max();
+
+    class Block {
+    public:
+        Point3 m_origin;
+        Point3 m_scale;   // 可以为负数 (经过翻转的变换)
+    };
+
+    PointsQuantized() = default;
+
+    explicit PointsQuantized(std::span<const Point3> points) {
+        append(points);
+    }
+
+    auto size() const {
+        return m_data.size() / 3 + m_pending.size();
+    }
+
+    auto empty() const {
+        return size() == 0;
+    }
+
+    auto memoryBytes() const {
+        return m_data.capacity() * sizeof(uint16_t) + m_blocks.capacity() * sizeof(Block) + m_pending.capacity() * sizeof(Point3);
+    }
+
+    auto blocks() const -> std::span<const Block> {
+        return m_blocks;
+    }
+
+    auto operator[](size_t i) const {
+        if (auto encoded = m_data.size() / 3; i >= encoded) {
+            return m_pending[i - encoded];
+        }
+        const auto& b = m_blocks[i / k_block_size];
+        return Point3(
+            b.m_origin.x + static_cast<float>(m_data[i * 3]) * b.m_scale.x,
+            b.m_origin.y + static_cast<float>(m_data[i * 3 + 1]) * b.m_scale.y,
+            b.m_origin.z + static_cast<float>(m_data[i * 3 + 2]) * b.m_scale.z
+        );
+    }
+
+    // 不足一块的点先以 float 保存, 凑满一块后再量化, 每个点只量化一次
+    auto append(std::span<const Point3> points) -> void;
+
+    // 把不足一块的点也量化, 之后不能再 append
+    auto flush() -> void;
+
+    auto clear() -> void {
+        m_blocks.clear();
+        m_data.clear();
+        m_pending.clear();
+    }
+
+    // 解码 [first, first + out.size()) 的点, 支持 AVX2 时一次解码 8 个点
+    auto decode(size_t first, std::span<Point3> out) const -> void;
+
+    auto decode() const -> std::vector<Point3>;
+
+    // 只读取块信息, 不解码点数据
+    auto bounds() const -> Bounds3;
+
+    // 第 i 块的包围盒 (不包括未量化的点)
+    auto blockBounds(size_t i) const -> Bounds3;
+
+    // p * scale + offset, 只修改块的原点和步长, 不改变量化数据, 也不增加误差
+    auto transform(const Point3& scale, const Point3& offset) -> void;
+
+    // 各轴最大量化误差
+    auto maxError() const -> Point3;
+
+private:
+    auto encodeBlock(std::span<const Point3> points) -> void;
+
+    std::vector<Block>    m_blocks;
+    std::vector<uint16_t> m_data;      // x, y, z 交错存储
+    std::vector<Point3>   m_pending;   // 不足一块, 尚未量化的点
+};
+}   // namespace tg
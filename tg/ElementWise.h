@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace tg::detail {
+// 按分量计算的小向量 (Point, Color 等).
+// 类型通过 k_members 列出各分量的成员指针, 例如 {&T::x, &T::y},
+// 所有运算都展开成对每个分量的一次运算, 没有循环和临时对象, 可以在 constexpr 中使用.
+template <typename T>
+concept ElementWise = requires {
+    typename T::value_t;
+    T::k_members.size();
+};
+
+template <ElementWise T>
+inline constexpr auto k_element_count = T::k_members.size();
+
+// 第 I 个分量, 标量参与运算时每个分量都取标量本身
+template <size_t I, typename T>
+constexpr auto element(const T& v) -> decltype(auto) {
+    if constexpr (ElementWise<T>) {
+        return v.*(T::k_members[I]);
+    }
+    else {
+        return v;
+    }
+}
+
+// 对第 I 个分量调用 op
+template <size_t I, typename Op, typename... Args>
+constexpr auto applyAt(Op& op, const Args&... args) -> decltype(auto) {
+    return op(element<I>(args)...);
+}
+
+// 逐分量计算 Result[i] = op(args[i]...)
+template <ElementWise Result, typename Op, typename... Args>
+constexpr auto zip(Op op, const Args&... args) -> Result {
+    Result res;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ((res.*(Result::k_members[I]) = static_cast<typename Result::value_t>(applyAt<I>(op, args...))), ...);
+    }(std::make_index_sequence<k_element_count<Result>>{});
+    return res;
+}
+
+// 逐分量计算之后用 reduce 合并, 例如点积
+template <ElementWise T, typename Op, typename Reduce, typename... Args>
+constexpr auto zipReduce(Op op, Reduce reduce, const T& first, const Args&... args) {
+    return [&]<size_t I0, size_t... I>(std::index_sequence<I0, I...>) {
+        auto res = applyAt<I0>(op, first, args...);
+        ((res = reduce(res, applyAt<I>(op, first, args...))), ...);
+        return res;
+    }(std::make_index_sequence<k_element_count<T>>{});
+}
+
+// 所有分量都满足 pred
+template <ElementWise T, typename Pred, typename... Args>
+constexpr auto allOf(Pred pred, const T& first, const Args&... args) -> bool {
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return (applyAt<I>(pred, first, args...) && ...);
+    }(std::make_index_sequence<k_element_count<T>>{});
+}
+}   // namespace tg::detail
@@ -0,0 +1,122 @@
+#pragma once
+#include <compare>
+#include <cstdint>
+
+namespace tg {
+// 24.8 定点数, 用于光栅化的亚像素坐标.
+// 所有运算都是整数运算, 不同编译器和平台的结果完全一致.
+// 整数可以隐式转换 (没有精度损失), 浮点数需要显式转换 (四舍五入到 1/256).
+class Fixed {
+public:
+    using raw_t = int32_t;
+
+    static constexpr int   k_frac_bits = 8;
+    static constexpr raw_t k_one       = raw_t{1} << k_frac_bits;
+    static constexpr raw_t k_frac_mask = k_one - 1;
+
+    constexpr Fixed() = default;
+
+    constexpr Fixed(int v)   // NOLINT
+        : m_raw(static_cast<raw_t>(v) * k_one) {}
+
+    constexpr explicit Fixed(float v)
+        : m_raw(static_cast<raw_t>(v * static_cast<float>(k_one) + (v >= 0 ? 0.5F : -0.5F))) {}
+
+    constexpr explicit Fixed(double v)
+        : m_raw(static_cast<raw_t>(v * static_cast<double>(k_one) + (v >= 0 ? 0.5 : -0.5))) {}
+
+    static constexpr auto fromRaw(raw_t raw) -> Fixed {
+        Fixed res;
+        res.m_raw = raw;
+        return res;
+    }
+
+    constexpr auto raw() const {
+        return m_raw;
+    }
+
+    // 向下取整, 即坐标所在的像素
+    constexpr auto floor() const -> int {
+        return m_raw >> k_frac_bits;
+    }
+
+    constexpr auto ceil() const -> int {
+        return (m_raw + k_frac_mask) >> k_frac_bits;
+    }
+
+    // 四舍五入, .5 向正无穷
+    constexpr auto round() const -> int {
+        return (m_raw + k_one / 2) >> k_frac_bits;
+    }
+
+    constexpr auto frac() const {
+        return fromRaw(m_raw & k_frac_mask);
+    }
+
+    constexpr explicit operator float() const {
+        return static_cast<float>(m_raw) / static_cast<float>(k_one);
+    }
+
+    constexpr explicit operator double() const {
+        return static_cast<double>(m_raw) / static_cast<double>(k_one);
+    }
+
+    constexpr explicit operator int() const {
+        return floor();
+    }
+
+    constexpr auto operator+=(Fixed v) -> Fixed& {
+        m_raw += v.m_raw;
+        return *this;
+    }
+
+    constexpr auto operator-=(Fixed v) -> Fixed& {
+        m_raw -= v.m_raw;
+        return *this;
+    }
+
+    constexpr auto operator*=(Fixed v) -> Fixed& {
+        return *this = *this * v;
+    }
+
+    constexpr auto operator/=(Fixed v) -> Fixed& {
+        return *this = *this / v;
+    }
+
+    friend constexpr auto operator+(Fixed a, Fixed b) -> Fixed {
+        return fromRaw(a.m_raw + b.m_raw);
+    }
+
+    friend constexpr auto operator-(Fixed a, Fixed b) -> Fixed {
+        return fromRaw(a.m_raw - b.m_raw);
+    }
+
+    friend constexpr auto operator-(Fixed a) -> Fixed {
+        return fromRaw(-a.m_raw);
+    }
+
+    // 乘除法使用 64 位中间结果, 向负无穷取整
+    friend constexpr auto operator*(Fixed a, Fixed b) -> Fixed {
+        return fromRaw(static_cast<raw_t>((static_cast<int64_t>(a.m_raw) * b.m_raw) >> k_frac_bits));
+    }
+
+    friend constexpr auto operator/(Fixed a, Fixed b) -> Fixed {
+        auto n = static_cast<int64_t>(a.m_raw) * k_one;
+        auto q = n / b.m_raw;
+        if ((n % b.m_raw != 0) && ((n < 0) != (b.m_raw < 0))) {
+            q--;
+        }
+        return fromRaw(static_cast<raw_t>(q));
+    }
+
+    friend constexpr auto operator==(Fixed a, Fixed b) -> bool = default;
+    friend constexpr auto operator<=>(Fixed a, Fixed b) = default;
+
+    friend constexpr auto abs(Fixed v) -> Fixed {
+        return fromRaw(v.m_raw < 0 ? -v.m_raw : v.m_raw);
+    }
+
+private:
+    raw_t m_raw = 0;
+};
+}   // namespace tg
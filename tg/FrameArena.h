@@ -0,0 +1,98 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <bit>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace tg {
+// 每帧重置的线性分配器, 用于只在一帧内使用的临时字符串和容器. 释放是空操作, reset 时一次性回收.
+// 容量不够时从堆上分配新块, 下一次 reset 把容量扩大到上一帧的总用量, 稳定后每帧不再访问堆.
+// 不是线程安全的
+//  arena.reset();
+//  std::pmr::vector<int> v(&arena);
+//  ImGui::TextUnformatted(arena.format("{} ms", ms).data());
+class FrameArena final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t k_default_capacity = 64 * 1024;
+
+    explicit FrameArena(size_t capacity = k_default_capacity)
+        : m_capacity(std::max<size_t>(capacity, 1)), m_block(std::make_unique<std::byte[]>(m_capacity)) {}
+
+    FrameArena(const FrameArena&)     = delete;
+    FrameArena(FrameArena&&)          = delete;
+    auto operator=(const FrameArena&) = delete;
+    auto operator=(FrameArena&&)      = delete;
+    ~FrameArena() override            = default;
+
+    // 之前分配的内存全部失效
+    auto reset() -> void {
+        if (!m_overflow.empty()) {
+            m_capacity = std::max(m_capacity * 2, std::bit_ceil(m_used));
+            m_block    = std::make_unique<std::byte[]>(m_capacity);
+            m_overflow.clear();
+        }
+        m_offset = 0;
+        m_used   = 0;
+    }
+
+    // 本帧分配的字节数 (不含对齐填充)
+    auto used() const {
+        return m_used;
+    }
+
+    auto capacity() const {
+        return m_capacity;
+    }
+
+    // 格式化到 arena 中, 结果以 '\0' 结尾, 可以直接传给 ImGui
+    template <typename... Args>
+    auto format(std::format_string<Args...> fmt, Args&&... args) -> std::string_view {
+        auto  size = std::formatted_size(fmt, std::forward<Args>(args)...);   // 格式化不会移动参数, 可以转发两次
+        auto* p    = static_cast<char*>(allocate(size + 1, 1));
+        std::format_to_n(p, static_cast<ptrdiff_t>(size), fmt, std::forward<Args>(args)...);
+        p[size] = '\0';
+        return {p, size};
+    }
+
+private:
+    auto do_allocate(size_t bytes, size_t alignment) -> void* override {
+        m_used += bytes;
+        // 对齐到 alignment 的位置
+        auto* base  = m_overflow.empty() ? m_block.get() : m_overflow.back().m_data.get();
+        auto  size  = m_overflow.empty() ? m_capacity : m_overflow.back().m_size;
+        auto  start = (reinterpret_cast<uintptr_t>(base) + m_offset + alignment - 1) & ~(alignment - 1);
+        auto  end   = start + bytes;
+        if (end <= reinterpret_cast<uintptr_t>(base) + size) {
+            m_offset = end - reinterpret_cast<uintptr_t>(base);
+            return reinterpret_cast<void*>(start);
+        }
+
+        // 新块至少是当前块的两倍
+        auto block_size = std::max(size * 2, bytes + alignment);
+        m_overflow.push_back({std::make_unique<std::byte[]>(block_size), block_size});
+        base     = m_overflow.back().m_data.get();
+        start    = (reinterpret_cast<uintptr_t>(base) + alignment - 1) & ~(alignment - 1);
+        m_offset = start + bytes - reinterpret_cast<uintptr_t>(base);
+        return reinterpret_cast<void*>(start);
+    }
+
+    auto do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/) -> void override {}
+
+    auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override {
+        return this == &other;
+    }
+
+    struct Block {
+        std::unique_ptr<std::byte[]> m_data;
+        size_t                       m_size;
+    };
+
+    size_t                       m_capacity;
+    std::unique_ptr<std::byte[]> m_block;
+    std::vector<Block>           m_overflow;
+    size_t                       m_offset = 0;   // 当前块 (最后一个溢出块或者首块) 中已使用的字节
+    size_t                       m_used   = 0;
+};
+}   // namespace tg
@@ -0,0 +1,382 @@
+#pragma once
+#include <tg/Point.h>
+#include <tg/parallel.h>
+
+#include <numeric>
+
+namespace tg {
+// 静态 k-d 树, 用于最近点, k 近邻和半径查询.
+// 按最大跨度的维度在中位数处切分, 节点按隐式二叉树下标存放 (i 的子节点为 2i+1, 2i+2), 不保存子节点指针.
+// 叶子中的点按维度分开连续存放 (SoA), 叶子内的距离计算是无分支的循环, 可以被编译器向量化.
+// 查询结果中的下标是构建时传入的点的下标.
+template <typename PointType>
+class KdTree {
+public:
+    using point_t = PointType;
+    using value_t = typename point_t::value_t;
+
+    static constexpr size_t k_dim       = point_t::k_members.size();
+    static constexpr size_t k_leaf_size = 32;
+    static constexpr size_t k_invalid   = std::numeric_limits<size_t>::max();
+
+    struct Neighbor {
+        size_t  m_index     = k_invalid;
+        value_t m_distance2 = std::numeric_limits<value_t>::infinity();   // 距离的平方
+
+        friend auto operator<(const Neighbor& a, const Neighbor& b) -> bool {
+            return a.m_distance2 < b.m_distance2;
+        }
+    };
+
+    KdTree() = default;
+
+    explicit KdTree(std::span<const point_t> points) {
+        build(points);
+    }
+
+    // 重新构建, 较大的子树在线程池中并行构建
+    auto build(std::span<const point_t> points) -> void {
+        m_size = points.size();
+        m_indices.resize(m_size);
+        std::iota(m_indices.begin(), m_indices.end(), size_t{0});
+        size_t depth = 0;
+        for (auto s = m_size; s > k_leaf_size; s = (s + 1) / 2) {
+            depth++;
+        }
+        m_nodes.assign((size_t{1} << depth) - 1, Node{});
+        buildNode(points, 0, 0, m_size);
+
+        for (auto& c : m_coords) {
+            c.resize(m_size);
+        }
+        parallelFor(0, m_size, k_parallel_grain, [&](size_t b, size_t e) {
+            for (auto i = b; i < e; i++) {
+                for (size_t d = 0; d < k_dim; d++) {
+                    m_coords[d][i] = points[m_indices[i]][d];
+                }
+            }
+        });
+    }
+
+    auto size() const {
+        return m_size;
+    }
+
+    auto empty() const {
+        return m_size == 0;
+    }
+
+    // 最近点, epsilon > 0 时为近似查询: 返回的点到 p 的距离不超过最近距离的 (1 + epsilon) 倍
+    auto nearest(const point_t& p, value_t epsilon = 0) const -> Neighbor {
+        Neighbor best;
+        search(p, best.m_distance2, pruneScale(epsilon), [&](size_t b, size_t e) {
+            value_t dist[k_leaf_size];   // NOLINT
+            leafDistances(p, b, e, dist);
+            for (auto i = b; i < e; i++) {
+                if (dist[i - b] < best.m_distance2) {
+                    best = {m_indices[i], dist[i - b]};
+                }
+            }
+        });
+        return best;
+    }
+
+    // k 近邻, 按距离从近到远写入 out; 点数不足 k 时 out 的大小小于 k
+    auto knn(const point_t& p, size_t k, std::vector<Neighbor>& out, value_t epsilon = 0) const -> void {
+        out.clear();
+        knnHeap(p, k, out, epsilon);
+        std::sort_heap(out.begin(), out.end());
+    }
+
+    // 距离不超过 radius 的所有点, 按距离从近到远写入 out
+    auto radius(const point_t& p, value_t radius, std::vector<Neighbor>& out) const -> void {
+        out.clear();
+        radiusAppend(p, radius, out);
+        std::sort(out.begin(), out.end());
+    }
+
+    // 并行批量最近点查询, 大小必须一致
+    auto nearest(std::span<const point_t> queries, std::span<Neighbor> out, value_t epsilon = 0) const -> void {
+        if (queries.size() != out.size()) {
+            throw tg_exception("KdTree::nearest size mismatch: {} != {}", queries.size(), out.size());
+        }
+        parallelFor(0, queries.size(), k_query_grain, [&](size_t b, size_t e) {
+            for (auto i = b; i < e; i++) {
+                out[i] = nearest(queries[i], epsilon);
+            }
+        });
+    }
+
+    // 并行批量 k 近邻, 第 i 个查询的结果为 out[i * k, (i + 1) * k), 点数不足时用无效的 Neighbor 填充
+    auto knn(std::span<const point_t> queries, size_t k, std::span<Neighbor> out, value_t epsilon = 0) const -> void {
+        if (queries.size() * k != out.size()) {
+            throw tg_exception("KdTree::knn size mismatch: {} * {} != {}", queries.size(), k, out.size());
+        }
+        parallelFor(0, queries.size(), k_query_grain, [&](size_t b, size_t e) {
+            std::vector<Neighbor> res;
+            for (auto i = b; i < e; i++) {
+                knn(queries[i], k, res, epsilon);
+                std::ranges::fill(std::ranges::copy(res, out.begin() + static_cast<ptrdiff_t>(i * k)).out, out.begin() + static_cast<ptrdiff_t>((i + 1) * k), Neighbor{});
+            }
+        });
+    }
+
+private:
+    template <typename>
+    friend class DynamicKdTree;
+
+    static constexpr size_t k_parallel_grain = 1 << 15;   // 子树点数超过这个值时并行构建
+    static constexpr size_t k_query_grain    = 1 << 10;
+
+    struct Node {
+        value_t  m_split = 0;
+        uint32_t m_dim   = 0;
+    };
+
+    static auto pruneScale(value_t epsilon) -> value_t {
+        return (1 + epsilon) * (1 + epsilon);
+    }
+
+    auto buildNode(std::span<const point_t> points, size_t node, size_t b, size_t e) -> void {
+        if (e - b <= k_leaf_size) {
+            return;
+        }
+        // 按包围盒最长的维度切分
+        point_t min = points[m_indices[b]];
+        point_t max = min;
+        for (auto i = b + 1; i < e; i++) {
+            const auto& p = points[m_indices[i]];
+            for (size_t d = 0; d < k_dim; d++) {
+                min[d] = std::min(min[d], p[d]);
+                max[d] = std::max(max[d], p[d]);
+            }
+        }
+        uint32_t dim = 0;
+        for (uint32_t d = 1; d < k_dim; d++) {
+            if (max[d] - min[d] > max[dim] - min[dim]) {
+                dim = d;
+            }
+        }
+
+        auto mid   = b + (e - b) / 2;
+        auto first = m_indices.begin();
+        std::nth_element(first + static_cast<ptrdiff_t>(b), first + static_cast<ptrdiff_t>(mid), first + static_cast<ptrdiff_t>(e), [&](size_t i, size_t j) {
+            return points[i][dim] < points[j][dim];
+        });
+        m_nodes[node] = {points[m_indices[mid]][dim], dim};
+
+        if (e - b > k_parallel_grain) {
+            parallelFor(0, 2, 1, [&](size_t c, size_t) {
+                if (c == 0) {
+                    buildNode(points, node * 2 + 1, b, mid);
+                }
+                else {
+                    buildNode(points, node * 2 + 2, mid, e);
+                }
+            });
+        }
+        else {
+            buildNode(points, node * 2 + 1, b, mid);
+            buildNode(points, node * 2 + 2, mid, e);
+        }
+    }
+
+    // 先进入 p 所在的一侧, 另一侧以到切分面的距离作为下界压栈, 下界乘以 scale 后不小于 bound2 的子树被跳过.
+    // visit(b, e) 处理一个叶子, 可以缩小 bound2
+    template <typename Visit>
+    auto search(const point_t& p, const value_t& bound2, value_t scale, Visit&& visit) const -> void {
+        if (m_size == 0) {
+            return;
+        }
+        struct Entry {
+            size_t  m_node;
+            size_t  m_begin;
+            size_t  m_end;
+            value_t m_distance2;
+        };
+        std::array<Entry, 64> stack;   // 深度不超过 64
+        size_t                top = 0;
+        stack[top++]              = {0, 0, m_size, 0};
+        while (top > 0) {
+            auto [node, b, e, d2] = stack[--top];
+            if (d2 * scale > bound2) {
+                continue;
+            }
+            while (e - b > k_leaf_size) {
+                const auto& n    = m_nodes[node];
+                auto        mid  = b + (e - b) / 2;
+                auto        diff = p[n.m_dim] - n.m_split;
+                auto        far  = std::max(d2, diff * diff);
+                if (diff < 0) {
+                    stack[top++] = {node * 2 + 2, mid, e, far};
+                    node         = node * 2 + 1;
+                    e            = mid;
+                }
+                else {
+                    stack[top++] = {node * 2 + 1, b, mid, far};
+                    node         = node * 2 + 2;
+                    b            = mid;
+                }
+            }
+            visit(b, e);
+        }
+    }
+
+    auto leafDistances(const point_t& p, size_t b, size_t e, value_t* out) const -> void {
+        for (auto i = b; i < e; i++) {
+            out[i - b] = 0;
+        }
+        for (size_t d = 0; d < k_dim; d++) {
+            const auto* c = m_coords[d].data();
+            auto        v = p[d];
+            for (auto i = b; i < e; i++) {
+                auto diff   = c[i] - v;
+                out[i - b] += diff * diff;
+            }
+        }
+    }
+
+    // 在 heap (按距离的大顶堆, 可以已有候选) 中保留最近的 k 个
+    auto knnHeap(const point_t& p, size_t k, std::vector<Neighbor>& heap, value_t epsilon) const -> void {
+        if (k == 0) {
+            return;
+        }
+        auto bound2 = heap.size() == k ? heap.front().m_distance2 : std::numeric_limits<value_t>::infinity();
+        search(p, bound2, pruneScale(epsilon), [&](size_t b, size_t e) {
+            value_t dist[k_leaf_size];   // NOLINT
+            leafDistances(p, b, e, dist);
+            for (auto i = b; i < e; i++) {
+                if (dist[i - b] >= bound2) {
+                    continue;
+                }
+                if (heap.size() == k) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                }
+                heap.push_back({m_indices[i], dist[i - b]});
+                std::push_heap(heap.begin(), heap.end());
+                if (heap.size() == k) {
+                    bound2 = heap.front().m_distance2;
+                }
+            }
+        });
+    }
+
+    auto radiusAppend(const point_t& p, value_t radius, std::vector<Neighbor>& out) const -> void {
+        // 距离等于 radius 的点也要返回, 下界等于 bound2 的子树不能跳过, 所以 bound2 稍微放大
+        auto radius2 = radius * radius;
+        auto bound2  = std::nextafter(radius2, std::numeric_limits<value_t>::infinity());
+        search(p, bound2, 1, [&](size_t b, size_t e) {
+            value_t dist[k_leaf_size];   // NOLINT
+            leafDistances(p, b, e, dist);
+            for (auto i = b; i < e; i++) {
+                if (dist[i - b] <= radius2) {
+                    out.push_back({m_indices[i], dist[i - b]});
+                }
+            }
+        });
+    }
+
+    size_t                                  m_size = 0;
+    std::vector<Node>                       m_nodes;
+    std::vector<size_t>                     m_indices;   // 树中第 i 个点在原始数据中的下标
+    std::array<std::vector<value_t>, k_dim> m_coords;    // 按树的顺序存放的各维坐标
+};
+
+// 可以插入点的 k-d 树.
+// 新插入的点先放在未建树的缓冲中线性扫描, 缓冲超过已建树点数的 1/4 时整体重建, 插入的均摊开销为 O(log n)
+template <typename PointType>
+class DynamicKdTree {
+public:
+    using point_t  = PointType;
+    using value_t  = typename point_t::value_t;
+    using Neighbor = typename KdTree<point_t>::Neighbor;
+
+    static constexpr size_t k_min_pending = 256;
+
+    DynamicKdTree() = default;
+
+    explicit DynamicKdTree(std::vector<point_t> points) {
+        setPoints(std::move(points));
+    }
+
+    auto setPoints(std::vector<point_t> points) -> void {
+        m_points = std::move(points);
+        rebuild();
+    }
+
+    // 返回新点的下标
+    auto insert(const point_t& p) -> size_t {
+        m_points.push_back(p);
+        if (m_points.size() - m_tree.size() > std::max(k_min_pending, m_tree.size() / 4)) {
+            rebuild();
+        }
+        return m_points.size() - 1;
+    }
+
+    auto rebuild() -> void {
+        m_tree.build(m_points);
+    }
+
+    auto points() const -> std::span<const point_t> {
+        return m_points;
+    }
+
+    auto size() const {
+        return m_points.size();
+    }
+
+    auto pendingCount() const {
+        return m_points.size() - m_tree.size();
+    }
+
+    auto nearest(const point_t& p, value_t epsilon = 0) const -> Neighbor {
+        auto best = m_tree.nearest(p, epsilon);
+        for (auto i = m_tree.size(); i < m_points.size(); i++) {
+            if (auto d = m_points[i].squared_distance_to(p); d < best.m_distance2) {
+                best = {i, d};
+            }
+        }
+        return best;
+    }
+
+    auto knn(const point_t& p, size_t k, std::vector<Neighbor>& out, value_t epsilon = 0) const -> void {
+        out.clear();
+        if (k == 0) {
+            return;
+        }
+        for (auto i = m_tree.size(); i < m_points.size(); i++) {
+            Neighbor n{i, m_points[i].squared_distance_to(p)};
+            if (out.size() < k) {
+                out.push_back(n);
+                std::push_heap(out.begin(), out.end());
+            }
+            else if (n < out.front()) {
+                std::pop_heap(out.begin(), out.end());
+                out.back() = n;
+                std::push_heap(out.begin(), out.end());
+            }
+        }
+        m_tree.knnHeap(p, k, out, epsilon);
+        std::sort_heap(out.begin(), out.end());
+    }
+
+    auto radius(const point_t& p, value_t radius, std::vector<Neighbor>& out) const -> void {
+        out.clear();
+        m_tree.radiusAppend(p, radius, out);
+        for (auto i = m_tree.size(); i < m_points.size(); i++) {
+            if (auto d = m_points[i].squared_distance_to(p); d <= radius * radius) {
+                out.push_back({i, d});
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+private:
+    std::vector<point_t> m_points;   // [0, m_tree.size()) 已建树, 之后的点在缓冲中
+    KdTree<point_t>      m_tree;
+};
+
+using KdTree2 = KdTree<Point2>;
+using KdTree3 = KdTree<Point3>;
+}   // namespace tg
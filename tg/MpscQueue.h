@@ -0,0 +1,66 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <atomic>
+#include <optional>
+
+namespace tg {
+// 无锁多生产者单消费者队列 (Vyukov), 任意线程 push 不会阻塞 (除了分配节点), 只能在一个线程 pop.
+// 生产者在交换头指针和链接节点之间被挂起时, 消费者暂时看不到它之后的元素, 下一次 pop 时可见
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue()
+        : m_head(new Node), m_tail(m_head.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        while (pop()) {
+        }
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue&)      = delete;
+    MpscQueue(MpscQueue&&)           = delete;
+    auto operator=(const MpscQueue&) = delete;
+    auto operator=(MpscQueue&&)      = delete;
+
+    auto push(T value) -> void {
+        auto* node = new Node;
+        node->m_value.emplace(std::move(value));
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        auto* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->m_next.store(node, std::memory_order_release);
+    }
+
+    // 只能在消费者线程调用, 队列为空时返回空
+    auto pop() -> std::optional<T> {
+        auto* tail = m_tail;
+        auto* next = tail->m_next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return std::nullopt;
+        }
+        // next 成为新的哨兵节点
+        m_tail = next;
+        std::optional<T> value(std::move(next->m_value));
+        next->m_value.reset();
+        delete tail;
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        return value;
+    }
+
+    // 近似的元素个数, 可在任意线程调用
+    auto size() const {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> m_next = nullptr;
+        std::optional<T>   m_value;
+    };
+
+    std::atomic<Node*>  m_head;   // 生产者: 最后一个节点
+    Node*               m_tail;   // 消费者: 哨兵节点, 下一个节点是第一个元素
+    std::atomic<size_t> m_size = 0;
+};
+}   // namespace tg
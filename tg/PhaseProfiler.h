@@ -0,0 +1,56 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <chrono>
+#include <vector>
+
+namespace tg {
+// 按顺序记录若干阶段的耗时, 用于启动等一次性流程.
+//  PhaseProfiler profiler;
+//  loadA();
+//  profiler.mark("A");   // 构造到这里
+//  loadB();
+//  profiler.mark("B");   // 上一次 mark 到这里
+//  spdlog::info("{}", profiler.summary());
+class PhaseProfiler {
+public:
+    class Phase {
+    public:
+        std::string              m_name;
+        std::chrono::nanoseconds m_duration;
+    };
+
+    PhaseProfiler()
+        : m_start(std::chrono::steady_clock::now()), m_last(m_start) {}
+
+    // 结束当前阶段, 下一个阶段从现在开始
+    auto mark(std::string_view name) -> void {
+        auto now = std::chrono::steady_clock::now();
+        m_phases.push_back({std::string{name}, now - m_last});
+        m_last = now;
+    }
+
+    auto phases() const -> const std::vector<Phase>& {
+        return m_phases;
+    }
+
+    // 构造到最后一次 mark
+    auto total() const -> std::chrono::nanoseconds {
+        return m_last - m_start;
+    }
+
+    // "总计 12.000000 ms: A 10.000000 ms, B 2.000000 ms"
+    auto summary() const -> std::string {
+        auto s = std::format("总计 {}:", formatReadableDuration(total()));
+        for (size_t i = 0; i < m_phases.size(); i++) {
+            s += std::format("{} {} {}", i == 0 ? "" : ",", m_phases[i].m_name, formatReadableDuration(m_phases[i].m_duration));
+        }
+        return s;
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_last;
+    std::vector<Phase>                    m_phases;
+};
+}   // namespace tg
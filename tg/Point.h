@@ -1,7 +1,10 @@
 #pragma once
+#include <tg/ElementWise.h>
+#include <tg/Fixed.h>
 #include <tg/utils.h>
 
 #include <cmath>
+#include <span>
 
 namespace tg {
 namespace detail {
@@ -39,6 +42,20 @@ public:
 
     using value_t     = ValueType;
 
+    // 各分量的成员指针, 运算符通过 detail::zip 逐分量展开
+    static constexpr auto k_members = []() {
+        using Base = PointValue<PointSize, ValueType>;
+        if constexpr (PointSize == 2) {
+            return std::array{&Base::x, &Base::y};
+        }
+        else if constexpr (PointSize == 3) {
+            return std::array{&Base::x, &Base::y, &Base::z};
+        }
+        else {
+            return std::array{&Base::x, &Base::y, &Base::z, &Base::w};
+        }
+    }();
+
     constexpr Point() = default;
 
     constexpr Point(value_t x, value_t y)
@@ -65,74 +82,36 @@ public:
         this->w = w;
     }
 
+    constexpr auto operator[](size_t i) -> value_t& {
+        return this->*k_members[i];
+    }
+
+    constexpr auto operator[](size_t i) const -> const value_t& {
+        return this->*k_members[i];
+    }
+
     constexpr auto operator+=(const Point& p) -> Point& {
-        this->x += p.x;
-        this->y += p.y;
-        if constexpr (PointSize > 2) {
-            this->z += p.z;
-        }
-        if constexpr (PointSize > 3) {
-            this->w += p.w;
-        }
-        return *this;
+        return *this = *this + p;
     }
 
     constexpr auto operator-=(const Point& p) -> Point& {
-        this->x -= p.x;
-        this->y -= p.y;
-        if constexpr (PointSize > 2) {
-            this->z -= p.z;
-        }
-        if constexpr (PointSize > 3) {
-            this->w -= p.w;
-        }
-        return *this;
+        return *this = *this - p;
     }
 
     constexpr auto operator*=(value_t c) -> Point& {
-        this->x *= c;
-        this->y *= c;
-        if constexpr (PointSize > 2) {
-            this->z *= c;
-        }
-        if constexpr (PointSize > 3) {
-            this->w *= c;
-        }
-        return *this;
+        return *this = *this * c;
     }
 
     constexpr auto operator/=(value_t c) -> Point& {
-        this->x /= c;
-        this->y /= c;
-        if constexpr (PointSize > 2) {
-            this->z /= c;
-        }
-        if constexpr (PointSize > 3) {
-            this->w /= c;
-        }
-        return *this;
+        return *this = *this / c;
     }
 
     friend constexpr auto operator==(const Point& p1, const Point& p2) -> bool {
         if constexpr (std::is_floating_point_v<value_t>) {
-            bool equal = equalF(p1.x, p2.x) && equalF(p1.y, p2.y);
-            if constexpr (PointSize > 2) {
-                equal = equal && equalF(p1.z, p2.z);
-            }
-            if constexpr (PointSize > 3) {
-                equal = equal && equalF(p1.w, p2.w);
-            }
-            return equal;
+            return detail::allOf([](value_t a, value_t b) { return equalF(a, b); }, p1, p2);
         }
         else {
-            bool equal = p1.x == p2.x && p1.y == p2.y;
-            if constexpr (PointSize > 2) {
-                equal = equal && p1.z == p2.z;
-            }
-            if constexpr (PointSize > 3) {
-                equal = equal && p1.w == p2.w;
-            }
-            return equal;
+            return detail::allOf(std::equal_to<>{}, p1, p2);
         }
     }
 
@@ -141,39 +120,15 @@ public:
     }
 
     friend constexpr auto operator+(const Point& p1, const Point& p2) -> Point {
-        if constexpr (PointSize == 2) {
-            return Point(p1.x + p2.x, p1.y + p2.y);
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(p1.x + p2.x, p1.y + p2.y, p1.z + p2.z);
-        }
-        else if constexpr (PointSize == 4) {
-            return Point(p1.x + p2.x, p1.y + p2.y, p1.z + p2.z, p1.w + p2.w);
-        }
+        return detail::zip<Point>(std::plus<>{}, p1, p2);
     }
 
     friend constexpr auto operator-(const Point& p1, const Point& p2) -> Point {
-        if constexpr (PointSize == 2) {
-            return Point(p1.x - p2.x, p1.y - p2.y);
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(p1.x - p2.x, p1.y - p2.y, p1.z - p2.z);
-        }
-        else if constexpr (PointSize == 4) {
-            return Point(p1.x - p2.x, p1.y - p2.y, p1.z - p2.z, p1.w - p2.w);
-        }
+        return detail::zip<Point>(std::minus<>{}, p1, p2);
     }
 
     friend constexpr auto operator*(const Point& p, value_t c) -> Point {
-        if constexpr (PointSize == 2) {
-            return Point(p.x * c, p.y * c);
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(p.x * c, p.y * c, p.z * c);
-        }
-        else if constexpr (PointSize == 4) {
-            return Point(p.x * c, p.y * c, p.z * c, p.w * c);
-        }
+        return detail::zip<Point>(std::multiplies<>{}, p, c);
     }
 
     friend constexpr auto operator*(value_t c, const Point& p) -> Point {
@@ -185,39 +140,21 @@ public:
     }
 
     friend constexpr auto operator-(const Point& p) -> Point {
-        if constexpr (PointSize == 2) {
-            return Point(-p.x, -p.y);
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(-p.x, -p.y, -p.z);
-        }
-        else if constexpr (PointSize == 4) {
-            return Point(-p.x, -p.y, -p.z, -p.w);
-        }
+        return detail::zip<Point>(std::negate<>{}, p);
     }
 
     friend constexpr auto operator/(const Point& p, value_t divisor) -> Point {
-        if constexpr (PointSize == 2) {
-            return Point(p.x / divisor, p.y / divisor);
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(p.x / divisor, p.y / divisor, p.z / divisor);
-        }
-        else if constexpr (PointSize == 4) {
-            return Point(p.x / divisor, p.y / divisor, p.z / divisor, p.w / divisor);
-        }
+        return detail::zip<Point>(std::divides<>{}, p, divisor);
+    }
+
+    // 逐分量转换类型, 例如 Point2 转换为 PointFixed2
+    template <typename U>
+    constexpr auto cast() const -> Point<PointSize, U> {
+        return detail::zip<Point<PointSize, U>>([](value_t v) { return static_cast<U>(v); }, *this);
     }
 
     constexpr auto abs() const {
-        if constexpr (PointSize == 2) {
-            return Point(std::abs(this->x), std::abs(this->y));
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(std::abs(this->x), std::abs(this->y), std::abs(this->z));
-        }
-        else if constexpr (PointSize == 4) {
-            return Point(std::abs(this->x), std::abs(this->y), std::abs(this->z), std::abs(this->w));
-        }
+        return detail::zip<Point>([](value_t v) { using std::abs; return abs(v); }, *this);
     }
 
     constexpr auto cross(const Point& vec) const
@@ -226,48 +163,43 @@ public:
         return Point(this->y * vec.z - this->z * vec.y, this->z * vec.x - this->x * vec.z, this->x * vec.y - this->y * vec.x);
     }
 
+    // 二维叉积 (z 分量), 正数表示 vec 在 *this 的逆时针方向
+    constexpr auto cross(const Point& vec) const -> value_t
+        requires(PointSize == 2)
+    {
+        return this->x * vec.y - this->y * vec.x;
+    }
+
     constexpr auto distance_to(const Point& vec) const -> value_t
         requires(PointSize == 2 || PointSize == 3)
     {
-        if constexpr (PointSize == 2) {
-            return std::sqrt(std::pow(this->x - vec.x, 2) + std::pow(this->y - vec.y, 2));
-        }
-        else if constexpr (PointSize == 3) {
-            return std::sqrt(std::pow(this->x - vec.x, 2) + std::pow(this->y - vec.y, 2) + std::pow(this->z - vec.z, 2));
-        }
+        return (*this - vec).length();
     }
 
     constexpr auto dot(const Point& vec) const -> value_t
         requires(PointSize == 2 || PointSize == 3)
     {
-        if constexpr (PointSize == 2) {
-            return this->x * vec.x + this->y * vec.y;
-        }
-        else if constexpr (PointSize == 3) {
-            return this->x * vec.x + this->y * vec.y + this->z * vec.z;
-        }
+        return detail::zipReduce(std::multiplies<>{}, std::plus<>{}, *this, vec);
     }
 
     constexpr auto length() const -> value_t
         requires(PointSize == 2 || PointSize == 3)
     {
-        if constexpr (PointSize == 2) {
-            return std::sqrt(this->x * this->x + this->y * this->y);
-        }
-        else if constexpr (PointSize == 3) {
-            return std::sqrt(this->x * this->x + this->y * this->y + this->z * this->z);
-        }
+        return std::sqrt(dot(*this));
+    }
+
+    // 距离比较时使用平方, 省去开方
+    constexpr auto squared_distance_to(const Point& vec) const -> value_t
+        requires(PointSize == 2 || PointSize == 3)
+    {
+        auto d = *this - vec;
+        return d.dot(d);
     }
 
     constexpr auto linear_interpolate(const Point& vec, value_t t) const
         requires(PointSize == 2 || PointSize == 3)
     {
-        if constexpr (PointSize == 2) {
-            return Point(this->x + t * (vec.x - this->x), this->y + t * (vec.y - this->y));
-        }
-        else if constexpr (PointSize == 3) {
-            return Point(this->x + t * (vec.x - this->x), this->y + t * (vec.y - this->y), this->z + t * (vec.z - this->z));
-        }
+        return detail::zip<Point>([t](value_t a, value_t b) { return a + t * (b - a); }, *this, vec);
     }
 
     constexpr auto normalized() const
@@ -275,12 +207,7 @@ public:
     {
         value_t len = length();
         if (!equalF(len, 0)) {
-            if constexpr (PointSize == 2) {
-                return Point(this->x / len, this->y / len);
-            }
-            else {
-                return Point(this->x / len, this->y / len, this->z / len);
-            }
+            return *this / len;
         }
         else {
             return *this;
@@ -307,8 +234,16 @@ public:
         *this = rotated(axis, radians);
     }
 
-    constexpr auto angle_to(const Point& vec) const -> value_t {
-        return atan2(cross(vec), dot(vec));
+    // 二维时为有符号角度 (-pi, pi], 逆时针为正; 三维时为无符号角度 [0, pi]
+    constexpr auto angle_to(const Point& vec) const -> value_t
+        requires(PointSize == 2 || PointSize == 3)
+    {
+        if constexpr (PointSize == 2) {
+            return std::atan2(cross(vec), dot(vec));
+        }
+        else {
+            return std::atan2(cross(vec).length(), dot(vec));
+        }
     }
 
     constexpr auto direction_to(const Point& other) const {
@@ -323,28 +258,42 @@ using PointInt2 = Point<2, int>;
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PointInt2, x, y)
 }   // namespace detail
 
-using Point2    = detail::Point<2>;
-using Point3    = detail::Point<3>;
-using PointInt2 = detail::Point<2, int>;
+using Point2      = detail::Point<2>;
+using Point3      = detail::Point<3>;
+using PointInt2   = detail::Point<2, int>;
+using PointFixed2 = detail::Point<2, Fixed>;   // 亚像素坐标, 用于光栅化
+
+// 定点坐标所在的像素
+inline constexpr auto PointFixed2ToInt(const PointFixed2& p) {
+    return PointInt2(p.x.floor(), p.y.floor());
+}
 
 inline constexpr auto Point2To3(const Point2& p) {
     return Point3(p.x, 0, p.y);
 }
 
-inline constexpr auto Point2To3(const std::vector<Point2>& p) {
-    std::vector<Point3> res;
-    res.resize(p.size());
-    for (size_t i = 0; i < p.size(); i++) {
-        res[i] = Point2To3(p[i]);
+// 批量转换到调用者提供的存储中, 大小必须一致
+inline constexpr auto Point2To3(std::span<const Point2> in, std::span<Point3> out) {
+    if (in.size() != out.size()) {
+        throw tg_exception("Point2To3 size mismatch: {} != {}", in.size(), out.size());
+    }
+    for (size_t i = 0; i < in.size(); i++) {
+        out[i] = Point2To3(in[i]);
     }
+}
+
+inline constexpr auto Point2To3(const std::vector<Point2>& p) {
+    std::vector<Point3> res(p.size());
+    Point2To3(p, res);
     return res;
 }
 
+// 每条折线一次分配, 数据量大时使用 PolylineSet (tg/Polyline.h)
 inline constexpr auto Point2To3(const std::vector<std::vector<Point2>>& p) {
     std::vector<std::vector<Point3>> res;
-    res.resize(p.size());
-    for (size_t i = 0; i < p.size(); i++) {
-        res[i] = Point2To3(p[i]);
+    res.reserve(p.size());
+    for (const auto& i : p) {
+        res.push_back(Point2To3(i));
     }
     return res;
 }
@@ -353,20 +302,26 @@ inline constexpr auto Point3To2(const Point3& p) {
     return Point2(p.x, p.z);
 }
 
-inline constexpr auto Point3To2(const std::vector<Point3>& p) {
-    std::vector<Point2> res;
-    res.resize(p.size());
-    for (size_t i = 0; i < p.size(); i++) {
-        res[i] = Point3To2(p[i]);
+inline constexpr auto Point3To2(std::span<const Point3> in, std::span<Point2> out) {
+    if (in.size() != out.size()) {
+        throw tg_exception("Point3To2 size mismatch: {} != {}", in.size(), out.size());
+    }
+    for (size_t i = 0; i < in.size(); i++) {
+        out[i] = Point3To2(in[i]);
     }
+}
+
+inline constexpr auto Point3To2(const std::vector<Point3>& p) {
+    std::vector<Point2> res(p.size());
+    Point3To2(p, res);
     return res;
 }
 
 inline constexpr auto Point3To2(const std::vector<std::vector<Point3>>& p) {
     std::vector<std::vector<Point2>> res;
-    res.resize(p.size());
-    for (size_t i = 0; i < p.size(); i++) {
-        res[i] = Point3To2(p[i]);
+    res.reserve(p.size());
+    for (const auto& i : p) {
+        res.push_back(Point3To2(i));
     }
     return res;
 }
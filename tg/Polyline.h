@@ -0,0 +1,145 @@
+#pragma once
+#include <tg/Point.h>
+
+#include <ranges>
+#include <span>
+
+namespace tg {
+// 多条折线, 所有点连续存放, 第 i 条折线为 [m_offsets[i], m_offsets[i + 1]) 的点.
+// 相比 std::vector<std::vector<Point>>, 只有两次堆分配, 每条折线可以直接以 std::span 访问.
+template <typename PointType>
+class PolylineSet {
+public:
+    using point_t = PointType;
+
+    PolylineSet() = default;
+
+    explicit PolylineSet(const std::vector<std::vector<point_t>>& polylines) {
+        size_t count = 0;
+        for (const auto& i : polylines) {
+            count += i.size();
+        }
+        reserve(polylines.size(), count);
+        for (const auto& i : polylines) {
+            push_back(i);
+        }
+    }
+
+    // 折线条数
+    auto size() const {
+        return m_offsets.size() - 1;
+    }
+
+    auto empty() const {
+        return size() == 0;
+    }
+
+    auto pointCount() const {
+        return m_points.size();
+    }
+
+    auto operator[](size_t i) const -> std::span<const point_t> {
+        return std::span(m_points).subspan(m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+
+    auto operator[](size_t i) -> std::span<point_t> {
+        return std::span(m_points).subspan(m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+
+    // 遍历每条折线, 元素为 std::span
+    auto polylines() const {
+        return std::views::iota(size_t{0}, size()) | std::views::transform([this](size_t i) { return (*this)[i]; });
+    }
+
+    // 所有折线的点
+    auto points() const -> std::span<const point_t> {
+        return m_points;
+    }
+
+    auto points() -> std::span<point_t> {
+        return m_points;
+    }
+
+    auto offsets() const -> std::span<const size_t> {
+        return m_offsets;
+    }
+
+    auto reserve(size_t polylines, size_t points) -> void {
+        m_offsets.reserve(polylines + 1);
+        m_points.reserve(points);
+    }
+
+    auto push_back(std::span<const point_t> polyline) -> void {
+        m_points.insert(m_points.end(), polyline.begin(), polyline.end());
+        m_offsets.push_back(m_points.size());
+    }
+
+    // 逐点构建折线: addPoint ... endPolyline
+    auto addPoint(const point_t& p) -> void {
+        m_points.push_back(p);
+    }
+
+    auto endPolyline() -> void {
+        m_offsets.push_back(m_points.size());
+    }
+
+    auto clear() -> void {
+        m_points.clear();
+        m_offsets.assign(1, 0);
+    }
+
+    auto memoryBytes() const {
+        return m_points.capacity() * sizeof(point_t) + m_offsets.capacity() * sizeof(size_t);
+    }
+
+    // 转换为另一种点类型, 折线结构不变, out 已有的存储会被复用
+    template <typename OtherPoint, typename Convert>
+    auto convertTo(PolylineSet<OtherPoint>& out, Convert convert) const -> void {
+        out.m_offsets.assign(m_offsets.begin(), m_offsets.end());
+        out.m_points.resize(m_points.size());
+        std::ranges::transform(m_points, out.m_points.begin(), convert);
+    }
+
+    template <typename OtherPoint, typename Convert>
+    auto convert(Convert convert) const -> PolylineSet<OtherPoint> {
+        PolylineSet<OtherPoint> res;
+        convertTo(res, convert);
+        return res;
+    }
+
+    auto toVectors() const -> std::vector<std::vector<point_t>> {
+        std::vector<std::vector<point_t>> res;
+        res.reserve(size());
+        for (auto i : polylines()) {
+            res.emplace_back(i.begin(), i.end());
+        }
+        return res;
+    }
+
+private:
+    template <typename>
+    friend class PolylineSet;
+
+    std::vector<point_t> m_points;
+    std::vector<size_t>  m_offsets{0};
+};
+
+using PolylineSet2 = PolylineSet<Point2>;
+using PolylineSet3 = PolylineSet<Point3>;
+
+inline auto Point2To3(const PolylineSet2& in, PolylineSet3& out) {
+    in.convertTo(out, [](const Point2& p) { return Point2To3(p); });
+}
+
+inline auto Point2To3(const PolylineSet2& p) {
+    return p.convert<Point3>([](const Point2& i) { return Point2To3(i); });
+}
+
+inline auto Point3To2(const PolylineSet3& in, PolylineSet2& out) {
+    in.convertTo(out, [](const Point3& p) { return Point3To2(p); });
+}
+
+inline auto Point3To2(const PolylineSet3& p) {
+    return p.convert<Point2>([](const Point3& i) { return Point3To2(i); });
+}
+}   // namespace tg
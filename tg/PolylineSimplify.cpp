@@ -0,0 +1,219 @@
+#include <tg/PolylineSimplify.h>
+
+#include <optional>
+#include <queue>
+
+namespace tg {
+namespace {
+// 点到线段距离的平方
+auto segmentDistance2(const Point2& p, const Point2& a, const Point2& b) -> float {
+    auto ab  = b - a;
+    auto len = ab.dot(ab);
+    if (len <= 0) {
+        return (p - a).dot(p - a);
+    }
+    auto t = std::clamp((p - a).dot(ab) / len, 0.F, 1.F);
+    auto d = p - (a + ab * t);
+    return d.dot(d);
+}
+
+auto triangleArea(const Point2& a, const Point2& b, const Point2& c) -> float {
+    return std::abs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+}
+
+// Liang-Barsky 线段裁剪, 返回裁剪后的参数区间 [t0, t1], 完全在外时返回空
+auto clipSegment(const Point2& p, const Point2& q, const Point2& min, const Point2& max) -> std::optional<std::pair<float, float>> {
+    auto  d    = q - p;
+    float t0   = 0;
+    float t1   = 1;
+    auto  edge = [&](float denom, float num) {
+        if (denom == 0) {
+            return num >= 0;
+        }
+        auto t = num / denom;
+        if (denom > 0) {
+            t1 = std::min(t1, t);
+        }
+        else {
+            t0 = std::max(t0, t);
+        }
+        return t0 <= t1;
+    };
+    if (edge(-d.x, p.x - min.x) && edge(d.x, max.x - p.x) && edge(-d.y, p.y - min.y) && edge(d.y, max.y - p.y)) {
+        return std::pair{t0, t1};
+    }
+    return std::nullopt;
+}
+}   // namespace
+
+auto simplifyDouglasPeucker(std::span<const Point2> points, float tolerance, std::vector<Point2>& out) -> void {
+    out.clear();
+    if (points.size() <= 2) {
+        out.assign(points.begin(), points.end());
+        return;
+    }
+
+    auto                                   tolerance2 = tolerance * tolerance;
+    std::vector<uint8_t>                   keep(points.size(), 0);
+    std::vector<std::pair<size_t, size_t>> stack{{0, points.size() - 1}};
+    keep.front() = 1;
+    keep.back()  = 1;
+    while (!stack.empty()) {
+        auto [a, b] = stack.back();
+        stack.pop_back();
+        float  max_distance = -1;
+        size_t index        = a;
+        for (auto i = a + 1; i < b; i++) {
+            if (auto d = segmentDistance2(points[i], points[a], points[b]); d > max_distance) {
+                max_distance = d;
+                index        = i;
+            }
+        }
+        if (max_distance > tolerance2) {
+            keep[index] = 1;
+            stack.emplace_back(a, index);
+            stack.emplace_back(index, b);
+        }
+    }
+    for (size_t i = 0; i < points.size(); i++) {
+        if (keep[i] != 0) {
+            out.push_back(points[i]);
+        }
+    }
+}
+
+auto simplifyVisvalingam(std::span<const Point2> points, float min_area, std::vector<Point2>& out) -> void {
+    out.clear();
+    auto n = points.size();
+    if (n <= 2) {
+        out.assign(points.begin(), points.end());
+        return;
+    }
+
+    std::vector<size_t> prev(n);
+    std::vector<size_t> next(n);
+    std::vector<float>  area(n, std::numeric_limits<float>::infinity());   // 首尾点不删除
+    for (size_t i = 0; i < n; i++) {
+        prev[i] = i - 1;
+        next[i] = i + 1;
+    }
+
+    using Item = std::pair<float, size_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<>> heap;
+    for (size_t i = 1; i + 1 < n; i++) {
+        area[i] = triangleArea(points[i - 1], points[i], points[i + 1]);
+        heap.emplace(area[i], i);
+    }
+
+    // 删除一个点后重新计算相邻点的面积, 面积不小于刚删除的点, 保证删除顺序单调
+    while (!heap.empty()) {
+        auto [a, i] = heap.top();
+        heap.pop();
+        if (a != area[i]) {   // 已经更新过的旧记录
+            continue;
+        }
+        if (a >= min_area) {
+            break;
+        }
+        area[i]       = -1;
+        next[prev[i]] = next[i];
+        prev[next[i]] = prev[i];
+        for (auto j : {prev[i], next[i]}) {
+            if (j == 0 || j == n - 1) {
+                continue;
+            }
+            area[j] = std::max(triangleArea(points[prev[j]], points[j], points[next[j]]), a);
+            heap.emplace(area[j], j);
+        }
+    }
+    for (size_t i = 0; i < n; i = next[i]) {
+        out.push_back(points[i]);
+    }
+}
+
+auto decimatePixelSnap(std::span<const Point2> points, std::vector<Point2>& out, float cell_size) -> void {
+    out.clear();
+    if (points.empty()) {
+        return;
+    }
+    auto inv  = 1 / cell_size;
+    auto cell = [inv](const Point2& p) {
+        return std::pair{std::floor(p.x * inv), std::floor(p.y * inv)};
+    };
+    auto last = cell(points.front());
+    out.push_back(points.front());
+    for (size_t i = 1; i < points.size(); i++) {
+        if (auto c = cell(points[i]); c != last) {
+            out.push_back(points[i]);
+            last = c;
+        }
+    }
+    if (points.size() > 1 && out.size() == 1) {
+        out.push_back(points.back());
+    }
+    else if (out.back() != points.back()) {
+        out.back() = points.back();
+    }
+}
+
+auto clipPolyline(std::span<const Point2> points, const Point2& min, const Point2& max, PolylineSet2& out, bool closed) -> void {
+    if (points.empty()) {
+        return;
+    }
+    if (points.size() == 1) {
+        const auto& p = points.front();
+        if (p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y) {
+            out.push_back(points);
+        }
+        return;
+    }
+
+    auto open     = false;
+    // 两个点闭合时首尾相连的线段与第一段重合, 按不闭合处理
+    auto segments = closed && points.size() > 2 ? points.size() : points.size() - 1;
+    for (size_t i = 0; i < segments; i++) {
+        const auto& p    = points[i];
+        const auto& q    = points[(i + 1) % points.size()];
+        auto        clip = clipSegment(p, q, min, max);
+        if (!clip) {
+            if (open) {
+                out.endPolyline();
+                open = false;
+            }
+            continue;
+        }
+        auto [t0, t1] = *clip;
+        // 从外部进入矩形, 开始新的一段
+        if (open && t0 > 0) {
+            out.endPolyline();
+            open = false;
+        }
+        if (!open) {
+            out.addPoint(t0 > 0 ? p + (q - p) * t0 : p);
+            open = true;
+        }
+        out.addPoint(t1 < 1 ? p + (q - p) * t1 : q);
+        if (t1 < 1) {
+            out.endPolyline();
+            open = false;
+        }
+    }
+    if (open) {
+        out.endPolyline();
+    }
+}
+
+auto PolylineLod::get(float tolerance) -> std::span<const Point2> {
+    if (!(tolerance > 0) || m_points.size() <= 2) {
+        return m_points;
+    }
+    // 取不大于 tolerance 的 2 的幂, 缩放比例变化不到一倍时复用同一级
+    auto level = static_cast<int>(std::floor(std::log2(tolerance)));
+    auto it    = m_levels.find(level);
+    if (it == m_levels.end()) {
+        it = m_levels.emplace(level, std::vector<Point2>{}).first;
+        simplifyDouglasPeucker(m_points, std::ldexp(1.F, level), it->second);
+    }
+    return it->second;
+}
+}   // namespace tg
@@ -0,0 +1,51 @@
+#pragma once
+#include <tg/Polyline.h>
+
+#include <map>
+
+namespace tg {
+// Douglas-Peucker 简化: 保留的折线与原折线的距离不超过 tolerance, 首尾点总是保留
+auto simplifyDouglasPeucker(std::span<const Point2> points, float tolerance, std::vector<Point2>& out) -> void;
+
+// Visvalingam-Whyatt 简化: 依次删除与相邻点构成的三角形面积最小的点, 直到最小面积不小于 min_area
+auto simplifyVisvalingam(std::span<const Point2> points, float min_area, std::vector<Point2>& out) -> void;
+
+// 屏幕空间抽稀: 落在同一个 cell_size 大小格子里的连续点只保留第一个 (以及整条折线的最后一个点).
+// 只需一次遍历, 用于绘制前去掉小于一个像素的线段
+auto decimatePixelSnap(std::span<const Point2> points, std::vector<Point2>& out, float cell_size = 1.F) -> void;
+
+// 把折线裁剪到 [min, max] 矩形内, 完全在矩形外的线段被去掉, 折线可能被分成多段追加到 out.
+// closed 时首尾相连, 少于 3 个点时忽略
+auto clipPolyline(std::span<const Point2> points, const Point2& min, const Point2& max, PolylineSet2& out, bool closed = false) -> void;
+
+// 折线的多分辨率缓存.
+// 容差按 2 的幂分级, 同一级只简化一次, 同一缩放比例下重绘时直接返回缓存的结果.
+class PolylineLod {
+public:
+    PolylineLod() = default;
+
+    explicit PolylineLod(std::vector<Point2> points)
+        : m_points(std::move(points)) {}
+
+    auto points() const -> std::span<const Point2> {
+        return m_points;
+    }
+
+    // 修改原折线会清空缓存
+    auto setPoints(std::vector<Point2> points) -> void {
+        m_points = std::move(points);
+        m_levels.clear();
+    }
+
+    // 返回容差不大于 tolerance 的简化结果 (Douglas-Peucker)
+    auto get(float tolerance) -> std::span<const Point2>;
+
+    auto cachedLevels() const {
+        return m_levels.size();
+    }
+
+private:
+    std::vector<Point2>                m_points;
+    std::map<int, std::vector<Point2>> m_levels;   // log2(容差) -> 简化结果
+};
+}   // namespace tg
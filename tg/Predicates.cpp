@@ -0,0 +1,384 @@
+#include <tg/Predicates.h>
+#include <tg/parallel.h>
+
+namespace tg {
+namespace {
+constexpr double k_epsilon            = std::numeric_limits<double>::epsilon() / 2;   // 2^-53
+constexpr double k_orient_error_bound = (3 + 16 * k_epsilon) * k_epsilon;
+constexpr double k_circle_error_bound = (10 + 96 * k_epsilon) * k_epsilon;
+
+// 扩展精度数: 若干个互不重叠的 double 之和, 按绝对值从小到大排列 (Shewchuk 的 expansion arithmetic).
+// 只在退化情况下使用, 不追求速度
+class Expansion {
+public:
+    Expansion() = default;
+
+    explicit Expansion(double v) {
+        if (v != 0) {
+            m_terms.push_back(v);
+        }
+    }
+
+    // a - b 的精确值
+    static auto difference(double a, double b) -> Expansion {
+        Expansion res;
+        auto      x = a - b;
+        auto      y = twoSumTail(a, -b, x);
+        if (y != 0) {
+            res.m_terms.push_back(y);
+        }
+        if (x != 0) {
+            res.m_terms.push_back(x);
+        }
+        return res;
+    }
+
+    friend auto operator+(const Expansion& e, double b) -> Expansion {
+        Expansion res;
+        auto      q = b;
+        for (auto i : e.m_terms) {
+            auto x = q + i;
+            auto y = twoSumTail(q, i, x);
+            if (y != 0) {
+                res.m_terms.push_back(y);
+            }
+            q = x;
+        }
+        if (q != 0) {
+            res.m_terms.push_back(q);
+        }
+        return res;
+    }
+
+    friend auto operator+(Expansion e, const Expansion& f) -> Expansion {
+        for (auto i : f.m_terms) {
+            e = e + i;
+        }
+        return e;
+    }
+
+    friend auto operator-(const Expansion& e) -> Expansion {
+        auto res = e;
+        for (auto& i : res.m_terms) {
+            i = -i;
+        }
+        return res;
+    }
+
+    friend auto operator-(const Expansion& e, const Expansion& f) -> Expansion {
+        return e + -f;
+    }
+
+    friend auto operator*(const Expansion& e, double b) -> Expansion {
+        Expansion res;
+        for (auto i : e.m_terms) {
+            auto x = i * b;
+            auto y = std::fma(i, b, -x);   // 乘积的舍入误差, 精确
+            res    = res + y + x;
+        }
+        return res;
+    }
+
+    friend auto operator*(const Expansion& e, const Expansion& f) -> Expansion {
+        Expansion res;
+        for (auto i : f.m_terms) {
+            res = res + e * i;
+        }
+        return res;
+    }
+
+    // 各项互不重叠, 绝对值最大的一项决定符号
+    auto sign() const -> int {
+        if (m_terms.empty()) {
+            return 0;
+        }
+        return m_terms.back() > 0 ? 1 : -1;
+    }
+
+private:
+    // x = fl(a + b) 时 a + b - x 的精确值
+    static auto twoSumTail(double a, double b, double x) -> double {
+        auto bv = x - a;
+        auto av = x - bv;
+        return (a - av) + (b - bv);
+    }
+
+    std::vector<double> m_terms;
+};
+
+auto sign(double v) -> int {
+    return (v > 0) - (v < 0);
+}
+
+auto orient2dExact(const Point2& a, const Point2& b, const Point2& c) -> int {
+    auto acx = Expansion::difference(a.x, c.x);
+    auto acy = Expansion::difference(a.y, c.y);
+    auto bcx = Expansion::difference(b.x, c.x);
+    auto bcy = Expansion::difference(b.y, c.y);
+    return (acx * bcy - acy * bcx).sign();
+}
+
+// double 计算的行列式和误差上界, |det| > bound 时符号可信
+auto orient2dFast(const Point2& a, const Point2& b, const Point2& c, double& bound) -> double {
+    auto left  = (double{a.x} - c.x) * (double{b.y} - c.y);
+    auto right = (double{a.y} - c.y) * (double{b.x} - c.x);
+    bound      = k_orient_error_bound * (std::abs(left) + std::abs(right));
+    return left - right;
+}
+
+auto incircleFast(const Point2& a, const Point2& b, const Point2& c, const Point2& d, double& bound) -> double {
+    double adx    = double{a.x} - d.x;
+    double ady    = double{a.y} - d.y;
+    double bdx    = double{b.x} - d.x;
+    double bdy    = double{b.y} - d.y;
+    double cdx    = double{c.x} - d.x;
+    double cdy    = double{c.y} - d.y;
+    auto   bdxcdy = bdx * cdy;
+    auto   cdxbdy = cdx * bdy;
+    auto   cdxady = cdx * ady;
+    auto   adxcdy = adx * cdy;
+    auto   adxbdy = adx * bdy;
+    auto   bdxady = bdx * ady;
+    auto   alift  = adx * adx + ady * ady;
+    auto   blift  = bdx * bdx + bdy * bdy;
+    auto   clift  = cdx * cdx + cdy * cdy;
+    bound         = k_circle_error_bound * ((std::abs(bdxcdy) + std::abs(cdxbdy)) * alift + (std::abs(cdxady) + std::abs(adxcdy)) * blift + (std::abs(adxbdy) + std::abs(bdxady)) * clift);
+    return alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+}
+
+auto incircleExact(const Point2& a, const Point2& b, const Point2& c, const Point2& d) -> int {
+    auto adx   = Expansion::difference(a.x, d.x);
+    auto ady   = Expansion::difference(a.y, d.y);
+    auto bdx   = Expansion::difference(b.x, d.x);
+    auto bdy   = Expansion::difference(b.y, d.y);
+    auto cdx   = Expansion::difference(c.x, d.x);
+    auto cdy   = Expansion::difference(c.y, d.y);
+    auto alift = adx * adx + ady * ady;
+    auto blift = bdx * bdx + bdy * bdy;
+    auto clift = cdx * cdx + cdy * cdy;
+    return (alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady)).sign();
+}
+
+// 射线 p -> +x 是否穿过边 e, 与 orient2d(e.a, e.b, p) > 0 等价, 大部分情况只需比较坐标
+auto crosses(const Point2& a, const Point2& b, const Point2& p) -> bool {
+    if (p.y < a.y || p.y >= b.y) {
+        return false;
+    }
+    auto [min_x, max_x] = std::minmax(a.x, b.x);
+    if (p.x < min_x) {
+        return true;
+    }
+    if (p.x >= max_x) {
+        return false;
+    }
+    return orient2d(a, b, p) > 0;
+}
+
+// 统一为 a.y < b.y, 水平边返回 false
+auto normalizeEdge(Point2& a, Point2& b) -> bool {
+    if (a.y > b.y) {
+        std::swap(a, b);
+    }
+    return a.y < b.y;
+}
+}   // namespace
+
+auto orient2d(const Point2& a, const Point2& b, const Point2& c) -> int {
+    double bound = 0;
+    auto   det   = orient2dFast(a, b, c, bound);
+    if (std::abs(det) > bound) {
+        return sign(det);
+    }
+    return orient2dExact(a, b, c);
+}
+
+auto incircle(const Point2& a, const Point2& b, const Point2& c, const Point2& d) -> int {
+    double bound = 0;
+    auto   det   = incircleFast(a, b, c, d, bound);
+    if (std::abs(det) > bound) {
+        return sign(det);
+    }
+    return incircleExact(a, b, c, d);
+}
+
+auto segmentsIntersect(const Point2& p1, const Point2& p2, const Point2& q1, const Point2& q2) -> bool {
+    auto d1 = orient2d(q1, q2, p1);
+    auto d2 = orient2d(q1, q2, p2);
+    auto d3 = orient2d(p1, p2, q1);
+    auto d4 = orient2d(p1, p2, q2);
+    if (d1 * d2 < 0 && d3 * d4 < 0) {
+        return true;
+    }
+    // 共线的端点是否落在另一条线段的包围盒内
+    auto on_segment = [](const Point2& a, const Point2& b, const Point2& p) {
+        return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+    };
+    return (d1 == 0 && on_segment(q1, q2, p1)) || (d2 == 0 && on_segment(q1, q2, p2)) || (d3 == 0 && on_segment(p1, p2, q1)) || (d4 == 0 && on_segment(p1, p2, q2));
+}
+
+auto orient2d(const Point2& a, const Point2& b, std::span<const Point2> points, std::span<int8_t> out) -> void {
+    if (points.size() != out.size()) {
+        throw tg_exception("orient2d size mismatch: {} != {}", points.size(), out.size());
+    }
+    // 第一遍只做 double 计算, 无分支便于向量化; 不确定的结果标记为 2, 第二遍精确求值
+    for (size_t i = 0; i < points.size(); i++) {
+        double bound = 0;
+        auto   det   = orient2dFast(a, b, points[i], bound);
+        out[i]       = static_cast<int8_t>(std::abs(det) > bound ? sign(det) : 2);
+    }
+    for (size_t i = 0; i < points.size(); i++) {
+        if (out[i] == 2) {
+            out[i] = static_cast<int8_t>(orient2dExact(a, b, points[i]));
+        }
+    }
+}
+
+auto incircle(const Point2& a, const Point2& b, const Point2& c, std::span<const Point2> points, std::span<int8_t> out) -> void {
+    if (points.size() != out.size()) {
+        throw tg_exception("incircle size mismatch: {} != {}", points.size(), out.size());
+    }
+    // 与 orient2d 相同的两遍
+    for (size_t i = 0; i < points.size(); i++) {
+        double bound = 0;
+        auto   det   = incircleFast(a, b, c, points[i], bound);
+        out[i]       = static_cast<int8_t>(std::abs(det) > bound ? sign(det) : 2);
+    }
+    for (size_t i = 0; i < points.size(); i++) {
+        if (out[i] == 2) {
+            out[i] = static_cast<int8_t>(incircleExact(a, b, c, points[i]));
+        }
+    }
+}
+
+auto segmentsIntersect(const Point2& p1, const Point2& p2, std::span<const Point2> q1, std::span<const Point2> q2, std::span<uint8_t> out) -> void {
+    if (q1.size() != q2.size() || q1.size() != out.size()) {
+        throw tg_exception("segmentsIntersect size mismatch: {}, {}, {}", q1.size(), q2.size(), out.size());
+    }
+    // 两个端点确定在另一条线段所在直线的同一侧时不相交, 四个方向都确定且两两异侧时相交, 其余情况 (接近共线) 标记为 2, 第二遍精确求值
+    auto same_side = [](double d1, double b1, double d2, double b2) {
+        return std::abs(d1) > b1 && std::abs(d2) > b2 && (d1 > 0) == (d2 > 0);
+    };
+    for (size_t i = 0; i < out.size(); i++) {
+        double b1 = 0;
+        double b2 = 0;
+        double b3 = 0;
+        double b4 = 0;
+        auto   d1 = orient2dFast(q1[i], q2[i], p1, b1);
+        auto   d2 = orient2dFast(q1[i], q2[i], p2, b2);
+        auto   d3 = orient2dFast(p1, p2, q1[i], b3);
+        auto   d4 = orient2dFast(p1, p2, q2[i], b4);
+        if (same_side(d1, b1, d2, b2) || same_side(d3, b3, d4, b4)) {
+            out[i] = 0;
+        }
+        else {
+            out[i] = std::abs(d1) > b1 && std::abs(d2) > b2 && std::abs(d3) > b3 && std::abs(d4) > b4 ? 1 : 2;
+        }
+    }
+    for (size_t i = 0; i < out.size(); i++) {
+        if (out[i] == 2) {
+            out[i] = segmentsIntersect(p1, p2, q1[i], q2[i]) ? 1 : 0;
+        }
+    }
+}
+
+auto pointInPolygon(std::span<const Point2> polygon, const Point2& p) -> bool {
+    auto inside = false;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        auto a = polygon[i];
+        auto b = polygon[(i + 1) % polygon.size()];
+        if (normalizeEdge(a, b) && crosses(a, b, p)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+PolygonLocator::PolygonLocator(std::span<const Point2> polygon) {
+    PolylineSet2 rings;
+    rings.push_back(polygon);
+    build(rings);
+}
+
+PolygonLocator::PolygonLocator(const PolylineSet2& rings) {
+    build(rings);
+}
+
+auto PolygonLocator::build(const PolylineSet2& rings) -> void {
+    static constexpr size_t k_max_bands = 1 << 16;
+
+    std::vector<Edge> edges;
+    edges.reserve(rings.pointCount());
+    for (auto ring : rings.polylines()) {
+        for (size_t i = 0; i < ring.size(); i++) {
+            auto a = ring[i];
+            auto b = ring[(i + 1) % ring.size()];
+            if (normalizeEdge(a, b)) {
+                edges.push_back({a, b});
+            }
+        }
+    }
+    m_edge_count = edges.size();
+    if (edges.empty()) {
+        return;
+    }
+
+    m_min_y = edges.front().a.y;
+    m_max_y = edges.front().b.y;
+    for (const auto& e : edges) {
+        m_min_y = std::min(m_min_y, e.a.y);
+        m_max_y = std::max(m_max_y, e.b.y);
+    }
+    // 条带数与边数相当, 一般形状的多边形每个条带只有少量边
+    auto bands   = std::clamp<size_t>(edges.size(), 1, k_max_bands);
+    m_band_scale = static_cast<float>(bands) / (m_max_y - m_min_y);
+
+    // 两遍: 先统计每个条带的边数, 再填入连续存储
+    auto band = [this, bands](float y) {
+        return std::min(static_cast<size_t>(std::max((y - m_min_y) * m_band_scale, 0.F)), bands - 1);
+    };
+    m_band_offsets.assign(bands + 1, 0);
+    for (const auto& e : edges) {
+        for (auto i = band(e.a.y); i <= band(e.b.y); i++) {
+            m_band_offsets[i + 1]++;
+        }
+    }
+    for (size_t i = 0; i < bands; i++) {
+        m_band_offsets[i + 1] += m_band_offsets[i];
+    }
+    m_band_edges.resize(m_band_offsets.back());
+    std::vector<size_t> cursor(m_band_offsets.begin(), m_band_offsets.end() - 1);
+    for (const auto& e : edges) {
+        for (auto i = band(e.a.y); i <= band(e.b.y); i++) {
+            m_band_edges[cursor[i]++] = e;
+        }
+    }
+}
+
+auto PolygonLocator::contains(const Point2& p) const -> bool {
+    if (!(p.y >= m_min_y && p.y < m_max_y)) {   // 同时排除 NaN
+        return false;
+    }
+    auto bands = m_band_offsets.size() - 1;
+    auto i     = std::min(static_cast<size_t>((p.y - m_min_y) * m_band_scale), bands - 1);
+    auto res   = false;
+    for (auto j = m_band_offsets[i]; j < m_band_offsets[i + 1]; j++) {
+        const auto& e = m_band_edges[j];
+        if (crosses(e.a, e.b, p)) {
+            res = !res;
+        }
+    }
+    return res;
+}
+
+auto PolygonLocator::contains(std::span<const Point2> points, std::span<uint8_t> out) const -> void {
+    if (points.size() != out.size()) {
+        throw tg_exception("PolygonLocator::contains size mismatch: {} != {}", points.size(), out.size());
+    }
+    static constexpr size_t k_grain = 1 << 14;
+    parallelFor(0, points.size(), k_grain, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            out[i] = contains(points[i]) ? 1 : 0;
+        }
+    });
+}
+}   // namespace tg
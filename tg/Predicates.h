@@ -0,0 +1,71 @@
+#pragma once
+#include <tg/Polyline.h>
+
+namespace tg {
+// 鲁棒几何谓词.
+// 先用 double 计算并与误差上界比较, 只有结果接近 0 (退化或接近退化) 时才用扩展精度算术精确求值,
+// 所以结果总是正确的符号, 而一般情况下的开销与直接计算相同.
+
+// c 在有向直线 a->b 的左侧 (逆时针) 返回 1, 右侧返回 -1, 共线返回 0
+auto orient2d(const Point2& a, const Point2& b, const Point2& c) -> int;
+
+// a, b, c 按逆时针排列时, d 在三点外接圆内返回 1, 圆外返回 -1, 共圆返回 0; 顺时针排列时符号相反
+auto incircle(const Point2& a, const Point2& b, const Point2& c, const Point2& d) -> int;
+
+// 线段 p1p2 与 q1q2 是否相交, 端点接触和共线重叠也算相交
+auto segmentsIntersect(const Point2& p1, const Point2& p2, const Point2& q1, const Point2& q2) -> bool;
+
+// 批量计算 points 中每个点相对 a->b 的方向, 大小必须一致
+auto orient2d(const Point2& a, const Point2& b, std::span<const Point2> points, std::span<int8_t> out) -> void;
+
+// 批量计算 points 中每个点相对 a, b, c 外接圆的位置, 大小必须一致
+auto incircle(const Point2& a, const Point2& b, const Point2& c, std::span<const Point2> points, std::span<int8_t> out) -> void;
+
+// 线段 p1p2 与每条线段 q1[i]q2[i] 是否相交, out[i] 为 1 或 0, 大小必须一致
+auto segmentsIntersect(const Point2& p1, const Point2& p2, std::span<const Point2> q1, std::span<const Point2> q2, std::span<uint8_t> out) -> void;
+
+// 点是否在多边形内 (奇偶规则, 首尾自动相连).
+// 边界上的点按半开规则归属: 同一条边两侧的多边形恰好有一个包含它, 不会重复或遗漏
+auto pointInPolygon(std::span<const Point2> polygon, const Point2& p) -> bool;
+
+// 针对同一个多边形的大量包含查询.
+// 预先把边按 y 分到等高的水平条带中, 查询时只检查点所在条带的边, 结果与 pointInPolygon 一致.
+// 支持多个环 (外环和洞, 奇偶规则)
+class PolygonLocator {
+public:
+    PolygonLocator() = default;
+
+    explicit PolygonLocator(std::span<const Point2> polygon);
+
+    explicit PolygonLocator(const PolylineSet2& rings);
+
+    auto contains(const Point2& p) const -> bool;
+
+    // 并行批量查询, out[i] 为 points[i] 是否在多边形内, 大小必须一致
+    auto contains(std::span<const Point2> points, std::span<uint8_t> out) const -> void;
+
+    auto edgeCount() const {
+        return m_edge_count;
+    }
+
+    auto bandCount() const {
+        return m_band_offsets.empty() ? 0 : m_band_offsets.size() - 1;
+    }
+
+private:
+    // a.y < b.y, 水平边不参与奇偶计数, 不保存
+    struct Edge {
+        Point2 a;
+        Point2 b;
+    };
+
+    auto build(const PolylineSet2& rings) -> void;
+
+    float               m_min_y      = 0;
+    float               m_max_y      = 0;
+    float               m_band_scale = 0;   // 1 / 条带高度
+    size_t              m_edge_count = 0;
+    std::vector<size_t> m_band_offsets;     // 第 i 个条带的边为 [m_band_offsets[i], m_band_offsets[i + 1])
+    std::vector<Edge>   m_band_edges;
+};
+}   // namespace tg
@@ -2,6 +2,9 @@
 #include <tg/Point.h>
 #include <tg/utils.h>
 
+#include <array>
+#include <span>
+
 namespace tg {
 class Rect {
 public:
@@ -16,7 +19,7 @@ public:
         }
     }
 
-    auto points() const -> const std::vector<Point2>& {
+    auto points() const -> std::span<const Point2, 4> {
         return m_points;
     }
 
@@ -71,10 +74,49 @@ public:
         *this = Rect(topLeft().x, topLeft().y, w, h, radians());
     }
 
+    // 轴对齐包围盒
+    auto bounds() const -> std::pair<Point2, Point2> {
+        auto min = m_points[0];
+        auto max = m_points[0];
+        for (const auto& p : m_points) {
+            min = Point2(std::min(min.x, p.x), std::min(min.y, p.y));
+            max = Point2(std::max(max.x, p.x), std::max(max.y, p.y));
+        }
+        return {min, max};
+    }
+
+    // 分离轴测试, 两个矩形的边法线共 4 个轴, 任一轴上投影不重叠则不相交 (接触算相交)
+    auto overlaps(const Rect& other) const -> bool {
+        auto separated = [](const Rect& a, const Rect& b) {
+            for (size_t i = 0; i < 2; i++) {
+                auto axis     = a.m_points[i + 1] - a.m_points[i];
+                auto normal   = Point2(-axis.y, axis.x);
+                auto [a0, a1] = a.project(normal);
+                auto [b0, b1] = b.project(normal);
+                if (a1 < b0 || b1 < a0) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        return !separated(*this, other) && !separated(other, *this);
+    }
+
 private:
-    std::vector<Point2> m_points  = std::vector<Point2>(4, Point2(0, 0));
-    float               m_width   = 0;
-    float               m_height  = 0;
-    float               m_radians = 0;
+    auto project(const Point2& axis) const -> std::pair<float, float> {
+        auto min = m_points[0].dot(axis);
+        auto max = min;
+        for (size_t i = 1; i < m_points.size(); i++) {
+            auto v = m_points[i].dot(axis);
+            min    = std::min(min, v);
+            max    = std::max(max, v);
+        }
+        return {min, max};
+    }
+
+    std::array<Point2, 4> m_points;   // 左上, 右上, 右下, 左下
+    float                 m_width   = 0;
+    float                 m_height  = 0;
+    float                 m_radians = 0;
 };
 }   // namespace tg
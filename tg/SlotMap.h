@@ -0,0 +1,209 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace tg {
+// SlotMap 中对象的句柄: 低 32 位为槽位序号, 高 32 位为槽位的代数.
+// 对象删除后槽位的代数加一, 旧句柄不再有效, 可以检测到使用已删除的对象. 值为 0 的句柄总是无效.
+// Tag 用于区分不同对象的句柄, 避免混用
+template <typename Tag>
+class Handle {
+public:
+    constexpr Handle() = default;
+
+    constexpr Handle(uint32_t index, uint32_t generation)
+        : m_value((static_cast<uint64_t>(generation) << 32U) | index) {}
+
+    static constexpr auto fromValue(uint64_t value) {
+        Handle h;
+        h.m_value = value;
+        return h;
+    }
+
+    constexpr auto index() const {
+        return static_cast<uint32_t>(m_value);
+    }
+
+    constexpr auto generation() const {
+        return static_cast<uint32_t>(m_value >> 32U);
+    }
+
+    constexpr auto value() const {
+        return m_value;
+    }
+
+    constexpr explicit operator bool() const {
+        return m_value != 0;
+    }
+
+    friend constexpr auto operator==(Handle left, Handle right) -> bool = default;
+
+private:
+    uint64_t m_value = 0;
+};
+
+// 带代数的槽位表: 对象连续存放 (遍历和缓存友好), 句柄通过槽位 O(1) 找到对象.
+// 删除时把最后一个对象移到空位, 所以对象的地址和遍历顺序会改变, 句柄保持不变.
+// 不是线程安全的
+template <typename T, typename Tag = T>
+class SlotMap {
+public:
+    using handle_t = Handle<Tag>;
+
+    template <typename... Args>
+    auto emplace(Args&&... args) -> handle_t {
+        uint32_t index = 0;
+        if (m_free_head != k_none) {
+            index       = m_free_head;
+            m_free_head = m_slots[index].m_target;
+        }
+        else {
+            if (m_slots.size() >= k_none) {
+                throw tg_exception("SlotMap full: {}", m_slots.size());
+            }
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({k_none, 1});
+        }
+        m_values.emplace_back(std::forward<Args>(args)...);
+        m_dense_to_slot.push_back(index);
+        m_slots[index].m_target = static_cast<uint32_t>(m_values.size() - 1);
+        return {index, m_slots[index].m_generation};
+    }
+
+    auto insert(T value) -> handle_t {
+        return emplace(std::move(value));
+    }
+
+    // 句柄无效时返回 false
+    auto erase(handle_t h) -> bool {
+        auto dense = denseIndex(h);
+        if (dense == k_none) {
+            return false;
+        }
+        auto last = static_cast<uint32_t>(m_values.size() - 1);
+        if (dense != last) {
+            m_values[dense]                          = std::move(m_values[last]);
+            m_dense_to_slot[dense]                   = m_dense_to_slot[last];
+            m_slots[m_dense_to_slot[dense]].m_target = dense;
+        }
+        m_values.pop_back();
+        m_dense_to_slot.pop_back();
+
+        // 代数为 0 的句柄等于空句柄, 回绕时跳过
+        auto& slot = m_slots[h.index()];
+        if (++slot.m_generation == 0) {
+            slot.m_generation = 1;
+        }
+        slot.m_target = m_free_head;
+        m_free_head   = h.index();
+        return true;
+    }
+
+    auto contains(handle_t h) const {
+        return denseIndex(h) != k_none;
+    }
+
+    // 句柄无效时返回空指针
+    auto get(handle_t h) -> T* {
+        auto dense = denseIndex(h);
+        return dense == k_none ? nullptr : &m_values[dense];
+    }
+
+    auto get(handle_t h) const -> const T* {
+        auto dense = denseIndex(h);
+        return dense == k_none ? nullptr : &m_values[dense];
+    }
+
+    // 句柄无效 (已删除或不属于这个表) 时抛出异常
+    auto at(handle_t h) -> T& {
+        return const_cast<T&>(std::as_const(*this).at(h));
+    }
+
+    auto at(handle_t h) const -> const T& {
+        auto dense = denseIndex(h);
+        if (dense == k_none) {
+            throw tg_exception("invalid handle: index {}, generation {}", h.index(), h.generation());
+        }
+        return m_values[dense];
+    }
+
+    // 第 i 个对象的句柄, 与 values() 的顺序对应
+    auto handleAt(size_t i) const -> handle_t {
+        auto index = m_dense_to_slot[i];
+        return {index, m_slots[index].m_generation};
+    }
+
+    auto values() -> std::span<T> {
+        return m_values;
+    }
+
+    auto values() const -> std::span<const T> {
+        return m_values;
+    }
+
+    auto begin() {
+        return m_values.begin();
+    }
+
+    auto end() {
+        return m_values.end();
+    }
+
+    auto begin() const {
+        return m_values.begin();
+    }
+
+    auto end() const {
+        return m_values.end();
+    }
+
+    auto size() const {
+        return m_values.size();
+    }
+
+    auto empty() const {
+        return m_values.empty();
+    }
+
+    auto reserve(size_t n) -> void {
+        m_values.reserve(n);
+        m_dense_to_slot.reserve(n);
+        m_slots.reserve(n);
+    }
+
+    // 删除所有对象, 之前的句柄全部失效
+    auto clear() -> void {
+        while (!m_values.empty()) {
+            erase(handleAt(m_values.size() - 1));
+        }
+    }
+
+private:
+    static constexpr uint32_t k_none = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        uint32_t m_target;   // 使用中: 对象在 m_values 中的位置; 空闲: 下一个空闲槽位
+        uint32_t m_generation;
+    };
+
+    auto denseIndex(handle_t h) const -> uint32_t {
+        if (h.index() >= m_slots.size()) {
+            return k_none;
+        }
+        const auto& slot = m_slots[h.index()];
+        // 空闲槽位的 m_target 指向其它槽位, 需要再确认对象确实属于这个槽位
+        if (slot.m_generation != h.generation() || slot.m_target >= m_values.size() || m_dense_to_slot[slot.m_target] != h.index()) {
+            return k_none;
+        }
+        return slot.m_target;
+    }
+
+    std::vector<T>        m_values;
+    std::vector<uint32_t> m_dense_to_slot;
+    std::vector<Slot>     m_slots;
+    uint32_t              m_free_head = k_none;
+};
+}   // namespace tg
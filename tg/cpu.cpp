@@ -0,0 +1,56 @@
+#include <tg/cpu.h>
+
+#if defined(TG_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <array>
+#include <intrin.h>
+#endif
+
+namespace tg::cpu {
+namespace {
+class Features {
+public:
+    bool m_avx2   = false;
+    bool m_avx512 = false;
+
+    static auto get() -> const Features& {
+        static const Features features = detect();
+        return features;
+    }
+
+private:
+    static auto detect() -> Features {
+        Features res;
+#if defined(TG_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        res.m_avx2   = __builtin_cpu_supports("avx2") != 0;
+        res.m_avx512 = __builtin_cpu_supports("avx512f") != 0;
+#elif defined(TG_X86) && defined(_MSC_VER)
+        std::array<int, 4> regs{};
+        __cpuid(regs.data(), 0);
+        if (regs[0] < 7) {
+            return res;
+        }
+        __cpuid(regs.data(), 1);
+        // 操作系统需要保存 ymm (xcr0 第 1, 2 位) 和 zmm (第 5, 6, 7 位) 寄存器
+        constexpr auto k_osxsave = 1 << 27;
+        if ((regs[2] & k_osxsave) == 0) {
+            return res;
+        }
+        auto xcr0 = _xgetbv(0);
+        __cpuidex(regs.data(), 7, 0);
+        res.m_avx2   = (xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5)) != 0;
+        res.m_avx512 = (xcr0 & 0xe6) == 0xe6 && (regs[1] & (1 << 16)) != 0;
+#endif
+        return res;
+    }
+};
+}   // namespace
+
+auto hasAvx2() -> bool {
+    return Features::get().m_avx2;
+}
+
+auto hasAvx512() -> bool {
+    return Features::get().m_avx512;
+}
+}   // namespace tg::cpu
@@ -0,0 +1,25 @@
+#pragma once
+
+// 运行时检测处理器支持的指令集.
+// SIMD 函数用 TG_TARGET_AVX2 / TG_TARGET_AVX512 单独按指令集编译, 整个程序不开启 -mavx2 或 /arch:AVX2,
+// 调用前用 cpu::hasAvx2() 等选择实现, 不支持时使用标量代码
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TG_X86
+#include <immintrin.h>
+#endif
+
+#if defined(TG_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TG_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#define TG_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+// msvc 不需要编译选项即可使用各指令集的 intrinsic
+#define TG_TARGET_AVX2
+#define TG_TARGET_AVX512
+#endif
+
+namespace tg::cpu {
+// AVX2 和 F16C (支持 AVX2 的处理器都支持 F16C)
+auto hasAvx2() -> bool;
+
+auto hasAvx512() -> bool;
+}   // namespace tg::cpu
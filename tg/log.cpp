@@ -0,0 +1,172 @@
+#include <tg/log.h>
+
+#include <fstream>
+#include <spdlog/async.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace tg {
+namespace {
+constexpr std::string_view k_binary_magic         = "TGLOG";
+constexpr uint8_t          k_binary_version       = 1;
+constexpr size_t           k_binary_record_header = 8 + 4 + 1 + 4;
+
+template <typename T>
+auto writeLittleEndian(std::string& buffer, T v) {
+    auto u = static_cast<std::make_unsigned_t<T>>(v);
+    for (size_t i = 0; i < sizeof(T); i++) {
+        buffer.push_back(static_cast<char>((u >> (i * 8)) & 0xFFU));
+    }
+}
+
+template <typename T>
+auto readLittleEndian(const char* p) -> T {
+    std::make_unsigned_t<T> u = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        u |= static_cast<std::make_unsigned_t<T>>(static_cast<uint8_t>(p[i])) << (i * 8);
+    }
+    return static_cast<T>(u);
+}
+
+// 只写入原始字段, 不经过 pattern 格式化
+class BinaryFileSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    explicit BinaryFileSink(const std::filesystem::path& path)
+        : m_file(path, std::ios::binary | std::ios::trunc) {
+        if (!m_file.is_open()) {
+            throw tg_exception("open binary log error: {}", path.string());
+        }
+        m_file.write(k_binary_magic.data(), static_cast<std::streamsize>(k_binary_magic.size()));
+        m_file.put(static_cast<char>(k_binary_version));
+    }
+
+protected:
+    auto sink_it_(const spdlog::details::log_msg& msg) -> void override {
+        m_buffer.clear();
+        writeLittleEndian(m_buffer, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count()));
+        writeLittleEndian(m_buffer, static_cast<uint32_t>(msg.thread_id));
+        writeLittleEndian(m_buffer, static_cast<uint8_t>(msg.level));
+        writeLittleEndian(m_buffer, static_cast<uint32_t>(msg.payload.size()));
+        m_buffer.append(msg.payload.data(), msg.payload.size());
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    }
+
+    auto flush_() -> void override {
+        m_file.flush();
+    }
+
+private:
+    std::ofstream m_file;
+    std::string   m_buffer;
+};
+}   // namespace
+
+auto LogOptions::argumentValues(std::string_view arg) -> std::optional<size_t> {
+    if (arg == "--log-level" || arg == "--trace-log") {
+        return 1;
+    }
+    if (arg == "--log-sync") {
+        return 0;
+    }
+    return std::nullopt;
+}
+
+auto LogOptions::parse(int argc, char** argv) -> LogOptions {
+    LogOptions options;
+    for (auto i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        auto             n   = argumentValues(arg);
+        if (!n) {
+            continue;
+        }
+        if (i + static_cast<int>(*n) >= argc) {
+            throw tg_exception("missing value: {}", arg);
+        }
+        if (arg == "--log-level") {
+            std::string value = argv[++i];
+            options.m_level   = spdlog::level::from_str(value);
+            if (options.m_level == spdlog::level::off && value != "off") {
+                throw tg_exception("invalid log level: {}", value);
+            }
+        }
+        else if (arg == "--trace-log") {
+            options.m_binary_file = std::filesystem::path(argv[++i]);
+        }
+        else {
+            options.m_synchronous = true;
+        }
+    }
+    return options;
+}
+
+auto initLogging(const LogOptions& options) -> void {
+#ifdef _WIN32
+    // 控制台按 UTF-8 输出中文
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+
+    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    console_sink->set_level(options.m_level);
+    // [时间戳] [日志级别] [线程ID] 消息
+    console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%t] %v");
+    std::vector<spdlog::sink_ptr> sinks{console_sink};
+    if (options.m_binary_file) {
+        sinks.push_back(std::make_shared<BinaryFileSink>(*options.m_binary_file));
+    }
+
+    std::shared_ptr<spdlog::logger> logger;
+    if (options.m_synchronous) {
+        logger = std::make_shared<spdlog::logger>("console", sinks.begin(), sinks.end());
+    }
+    else {
+        // 只有一个后台线程, 日志按提交顺序输出
+        spdlog::init_thread_pool(options.m_queue_size, 1);
+        logger = std::make_shared<spdlog::async_logger>("console", sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    }
+    logger->set_level(options.m_binary_file ? spdlog::level::trace : options.m_level);
+    logger->flush_on(spdlog::level::err);
+    spdlog::set_default_logger(logger);
+    spdlog::flush_every(options.m_flush_interval);
+}
+
+auto readBinaryLog(const std::filesystem::path& path, const std::function<void(const BinaryLogRecord&)>& callback) -> size_t {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw tg_exception("open binary log error: {}", path.string());
+    }
+    std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (!std::string_view(data).starts_with(k_binary_magic) || data.size() <= k_binary_magic.size()) {
+        throw tg_exception("invalid binary log: {}", path.string());
+    }
+    if (auto version = static_cast<uint8_t>(data[k_binary_magic.size()]); version != k_binary_version) {
+        throw tg_exception("unsupported binary log version: {}", version);
+    }
+
+    size_t count = 0;
+    size_t pos   = k_binary_magic.size() + 1;
+    while (pos < data.size()) {
+        if (data.size() - pos < k_binary_record_header) {
+            throw tg_exception("binary log truncated: {}", path.string());
+        }
+        const auto*     p = data.data() + pos;
+        BinaryLogRecord record;
+        record.m_time   = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(readLittleEndian<int64_t>(p))));
+        record.m_thread = readLittleEndian<uint32_t>(p + 8);
+        record.m_level  = static_cast<spdlog::level::level_enum>(readLittleEndian<uint8_t>(p + 12));
+        auto length     = readLittleEndian<uint32_t>(p + 13);
+        pos            += k_binary_record_header;
+        if (data.size() - pos < length) {
+            throw tg_exception("binary log truncated: {}", path.string());
+        }
+        record.m_message  = std::string_view(data).substr(pos, length);
+        pos              += length;
+        callback(record);
+        count++;
+    }
+    return count;
+}
+}   // namespace tg
@@ -0,0 +1,131 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace tg {
+class LogOptions {
+public:
+    // 只读取日志相关的参数, 忽略其它参数
+    static auto parse(int argc, char** argv) -> LogOptions;
+
+    // 参数名是否属于日志相关参数, 返回参数需要的值的个数, 不属于时返回空
+    static auto argumentValues(std::string_view arg) -> std::optional<size_t>;
+
+    spdlog::level::level_enum            m_level          = spdlog::level::info;       // 控制台输出的最低级别
+    size_t                               m_queue_size     = 8192;                      // 异步队列长度, 满时丢弃最旧的日志
+    std::chrono::seconds                 m_flush_interval = std::chrono::seconds(1);
+    bool                                 m_synchronous    = false;                     // 同步输出, 用于调试崩溃时不丢失日志
+    std::optional<std::filesystem::path> m_binary_file;                                // 二进制日志, 记录包括 trace 在内的所有级别
+};
+
+// 安装默认 logger: 日志放入环形队列, 由后台线程输出到控制台 (和二进制日志), 调用线程不等待控制台 I/O.
+// 队列满时覆盖最旧的日志而不是阻塞调用者. 退出前调用 spdlog::shutdown() 输出队列中剩余的日志
+auto initLogging(const LogOptions& options = {}) -> void;
+
+// 二进制日志, 不格式化消息以外的字段, 用于大量 trace 日志.
+// 文件头 "TGLOG" + 版本号(u8), 之后每条记录为: 时间 (i64, 纪元以来的纳秒), 线程 id (u32), 级别 (u8), 消息长度 (u32), 消息 (UTF-8), 均为小端
+class BinaryLogRecord {
+public:
+    std::chrono::system_clock::time_point m_time;
+    uint32_t                              m_thread = 0;
+    spdlog::level::level_enum             m_level  = spdlog::level::info;
+    std::string_view                      m_message;   // 只在回调中有效
+};
+
+// 依次回调每条记录, 返回记录数, 文件损坏时抛出异常
+auto readBinaryLog(const std::filesystem::path& path, const std::function<void(const BinaryLogRecord&)>& callback) -> size_t;
+
+namespace detail {
+// 每个调用点一个, 每秒最多放行 per_second 条
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(uint32_t per_second)
+        : m_per_second(per_second) {}
+
+    // 返回 true 时记录日志, suppressed 为之前被丢弃而还没有报告的条数
+    auto acquire(uint64_t& suppressed) -> bool {
+        constexpr int64_t k_window = 1'000'000'000;
+        auto              now      = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        auto              start    = m_window_start.load(std::memory_order_relaxed);
+        if (now - start >= k_window && m_window_start.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            m_count.store(0, std::memory_order_relaxed);
+        }
+        if (m_count.fetch_add(1, std::memory_order_relaxed) < m_per_second) {
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    uint32_t              m_per_second;
+    std::atomic<int64_t>  m_window_start = -1'000'000'000;
+    std::atomic<uint32_t> m_count        = 0;
+    std::atomic<uint64_t> m_suppressed   = 0;
+};
+
+// 每个调用点一个, 连续相同的消息只记录第一条, 之后每秒最多报告一次重复次数
+class LogDeduplicator {
+public:
+    // 返回 true 时记录日志; repeated 为上一条消息被省略的重复次数, 需要在这条日志之前报告
+    auto check(std::string_view message, uint64_t& repeated) -> bool {
+        auto            hash = std::hash<std::string_view>{}(message);
+        auto            now  = std::chrono::steady_clock::now();
+        std::lock_guard lock(m_mutex);
+        if (hash == m_last_hash && m_has_last) {
+            m_repeated++;
+            if (now - m_last_report < std::chrono::seconds(1)) {
+                return false;
+            }
+            // 一直重复时定期报告, 否则看不到这条消息还在出现
+            m_last_report = now;
+            repeated      = std::exchange(m_repeated, 0);
+            return true;
+        }
+        m_has_last    = true;
+        m_last_hash   = hash;
+        m_last_report = now;
+        repeated      = std::exchange(m_repeated, 0);
+        return true;
+    }
+
+private:
+    std::mutex                            m_mutex;
+    bool                                  m_has_last  = false;
+    size_t                                m_last_hash = 0;
+    uint64_t                              m_repeated  = 0;
+    std::chrono::steady_clock::time_point m_last_report;
+};
+}   // namespace detail
+}   // namespace tg
+
+// 热路径中的日志, 每个调用点每秒最多记录 per_second 条, 被丢弃的条数在下一条日志之前报告
+//  TG_LOG_RATE_LIMITED(spdlog::level::err, 5, "callEvent error: {}", e.what());
+#define TG_LOG_RATE_LIMITED(level, per_second, ...)                                                 \
+    do {                                                                                            \
+        static ::tg::detail::LogRateLimiter tg_log_limiter_(per_second);                            \
+        if (uint64_t tg_log_suppressed_ = 0; tg_log_limiter_.acquire(tg_log_suppressed_)) {         \
+            if (tg_log_suppressed_ > 0) {                                                           \
+                ::spdlog::log(level, "({} messages suppressed by rate limit)", tg_log_suppressed_); \
+            }                                                                                       \
+            ::spdlog::log(level, __VA_ARGS__);                                                      \
+        }                                                                                           \
+    } while (false)
+
+// 连续相同的消息只记录一次, 之后报告重复次数. 消息总是会被格式化, 用于可能刷屏但频率不高的日志
+#define TG_LOG_DEDUP(level, ...)                                                                     \
+    do {                                                                                             \
+        static ::tg::detail::LogDeduplicator tg_log_dedup_;                                          \
+        auto tg_log_message_ = std::format(__VA_ARGS__);                                             \
+        if (uint64_t tg_log_repeated_ = 0; tg_log_dedup_.check(tg_log_message_, tg_log_repeated_)) { \
+            if (tg_log_repeated_ > 0) {                                                              \
+                ::spdlog::log(level, "(last message repeated {} times)", tg_log_repeated_);          \
+            }                                                                                        \
+            ::spdlog::log(level, "{}", tg_log_message_);                                             \
+        }                                                                                            \
+    } while (false)
@@ -0,0 +1,52 @@
+#include <tg/log.h>
+#include <tg/parallel.h>
+
+namespace tg {
+auto ThreadPool::getInstance() -> ThreadPool& {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1U) - 1);
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    m_threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        m_threads.emplace_back([this](const std::stop_token& stop) {
+            run(stop);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto& t : m_threads) {
+        t.request_stop();
+    }
+    m_cv.notify_all();
+}
+
+auto ThreadPool::submit(std::function<void()> task) -> void {
+    {
+        std::scoped_lock lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+auto ThreadPool::run(const std::stop_token& stop) -> void {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            if (!m_cv.wait(lock, stop, [this]() { return !m_tasks.empty(); })) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        try {
+            task();
+        } catch (std::exception& e) {
+            TG_LOG_RATE_LIMITED(spdlog::level::err, 5, "thread pool task error: {}", e.what());
+        }
+    }
+}
+}   // namespace tg
@@ -0,0 +1,111 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace tg {
+// 常驻线程池, 工作线程数为硬件线程数 - 1, 调用 parallelFor 的线程也参与计算
+class ThreadPool {
+public:
+    static auto getInstance() -> ThreadPool&;
+
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)     = delete;
+    ThreadPool(ThreadPool&&)          = delete;
+    auto operator=(const ThreadPool&) = delete;
+    auto operator=(ThreadPool&&)      = delete;
+
+    auto threadCount() const {
+        return m_threads.size();
+    }
+
+    auto submit(std::function<void()> task) -> void;
+
+private:
+    auto run(const std::stop_token& stop) -> void;
+
+    std::mutex                        m_mutex;
+    std::condition_variable_any       m_cv;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<std::jthread>         m_threads;
+};
+
+namespace detail {
+// parallelFor 的共享状态, 工作线程可能在 parallelFor 返回之后才开始执行, 所以用 shared_ptr 保存
+class ParallelForState {
+public:
+    auto runChunks() -> void {
+        for (;;) {
+            auto chunk = m_next.fetch_add(1);
+            if (chunk >= m_chunks) {
+                return;
+            }
+            auto b = m_begin + chunk * m_grain;
+            auto e = std::min(b + m_grain, m_end);
+            try {
+                m_func(b, e);
+            } catch (...) {
+                std::scoped_lock lock(m_mutex);
+                if (!m_exception) {
+                    m_exception = std::current_exception();
+                }
+            }
+            if (m_done.fetch_add(1) + 1 == m_chunks) {
+                m_done.notify_all();
+            }
+        }
+    }
+
+    size_t                              m_begin;
+    size_t                              m_end;
+    size_t                              m_grain;
+    size_t                              m_chunks;
+    std::function<void(size_t, size_t)> m_func;
+    std::atomic<size_t>                 m_next = 0;
+    std::atomic<size_t>                 m_done = 0;
+    std::mutex                          m_mutex;
+    std::exception_ptr                  m_exception;
+};
+}   // namespace detail
+
+// 把 [begin, end) 按 grain 分块, 并行执行 f(块起点, 块终点).
+// 调用线程也会领取分块执行, 等待时不占用工作线程, 所以可以在 f 中嵌套调用.
+// f 抛出的第一个异常会在所有分块结束后重新抛出.
+template <typename F>
+auto parallelFor(size_t begin, size_t end, size_t grain, F&& f) -> void {
+    if (begin >= end) {
+        return;
+    }
+    grain       = std::max<size_t>(grain, 1);
+    auto  count = (end - begin + grain - 1) / grain;
+    auto& pool  = ThreadPool::getInstance();
+    if (count == 1 || pool.threadCount() == 0) {
+        f(begin, end);
+        return;
+    }
+
+    auto state      = std::make_shared<detail::ParallelForState>();
+    state->m_begin  = begin;
+    state->m_end    = end;
+    state->m_grain  = grain;
+    state->m_chunks = count;
+    state->m_func   = [&f](size_t b, size_t e) { f(b, e); };
+    for (size_t i = 0; i < std::min(count - 1, pool.threadCount()); i++) {
+        pool.submit([state]() { state->runChunks(); });
+    }
+    state->runChunks();
+    for (auto done = state->m_done.load(); done < count; done = state->m_done.load()) {
+        state->m_done.wait(done);
+    }
+    if (state->m_exception) {
+        std::rethrow_exception(state->m_exception);
+    }
+}
+}   // namespace tg
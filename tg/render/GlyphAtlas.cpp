@@ -0,0 +1,290 @@
+#include <tg/parallel.h>
+#include <tg/render/GlyphAtlas.h>
+
+#include <fstream>
+
+// imgui 中已经带有 stb_truetype, 以 static 方式在这个文件中再实例化一份, 不与 imgui 的符号冲突
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <imstb_truetype.h>
+
+namespace tg::render {
+namespace {
+constexpr char32_t k_replacement = 0xFFFD;
+
+// 解码一个 UTF-8 字符, 非法的字节序列返回 U+FFFD 并跳过一个字节
+auto decodeUtf8(std::string_view text, size_t& i) -> char32_t {
+    auto c = static_cast<uint8_t>(text[i++]);
+    if (c < 0x80) {
+        return c;
+    }
+    size_t   length = 0;
+    char32_t res    = 0;
+    if ((c & 0xE0) == 0xC0) {
+        length = 1;
+        res    = c & 0x1F;
+    }
+    else if ((c & 0xF0) == 0xE0) {
+        length = 2;
+        res    = c & 0x0F;
+    }
+    else if ((c & 0xF8) == 0xF0) {
+        length = 3;
+        res    = c & 0x07;
+    }
+    else {
+        return k_replacement;
+    }
+    if (i + length > text.size()) {
+        return k_replacement;
+    }
+    for (size_t k = 0; k < length; k++) {
+        auto next = static_cast<uint8_t>(text[i + k]);
+        if ((next & 0xC0) != 0x80) {
+            return k_replacement;
+        }
+        res = (res << 6) | (next & 0x3F);
+    }
+    i += length;
+    return res;
+}
+
+// 逐字形排版, visit(字形, 基线起点 x, 基线 y)
+template <typename Visit>
+auto layout(GlyphAtlas& atlas, std::string_view utf8, const Point2& pos, Visit&& visit) -> void {
+    auto                     x        = pos.x;
+    auto                     baseline = pos.y + atlas.ascent();
+    const GlyphAtlas::Glyph* previous = nullptr;
+    for (size_t i = 0; i < utf8.size();) {
+        auto c = decodeUtf8(utf8, i);
+        if (c == '\n') {
+            x         = pos.x;
+            baseline += atlas.lineHeight();
+            previous  = nullptr;
+            continue;
+        }
+        const auto& glyph = atlas.glyph(c);
+        if (previous != nullptr) {
+            x += atlas.kerning(*previous, glyph);
+        }
+        visit(glyph, x, baseline);
+        x        += glyph.m_advance;
+        previous  = &glyph;
+    }
+}
+}   // namespace
+
+struct Font::Info {
+    stbtt_fontinfo m_info;
+};
+
+Font::Font(const std::filesystem::path& path, int index)
+    : m_path(path), m_info(std::make_unique<Info>()) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw tg_exception("open font error: {}", path.string());
+    }
+    m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    auto offset = m_data.empty() ? -1 : stbtt_GetFontOffsetForIndex(m_data.data(), index);
+    if (offset < 0 || stbtt_InitFont(&m_info->m_info, m_data.data(), offset) == 0) {
+        throw tg_exception("invalid font: {}, index {}", path.string(), index);
+    }
+}
+
+Font::~Font() = default;
+
+auto Font::getDefault() -> std::shared_ptr<const Font> {
+    static const auto font = []() {
+        // 依次尝试各平台常见的中文字体
+        static constexpr std::array k_candidates{
+            R"(c:\Windows\Fonts\msyh.ttc)",
+            "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+            "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+            "/usr/share/fonts/google-noto-cjk/NotoSansCJK-Regular.ttc",
+            "/usr/share/fonts/truetype/wqy/wqy-microhei.ttc",
+            "/usr/share/fonts/wenquanyi/wqy-microhei/wqy-microhei.ttc",
+            "/System/Library/Fonts/PingFang.ttc",
+        };
+        for (const auto* i : k_candidates) {
+            if (std::error_code ec; std::filesystem::exists(i, ec)) {
+                spdlog::info("default font: {}", i);
+                return std::make_shared<const Font>(i);
+            }
+        }
+        throw tg_exception("no CJK font found");
+    }();
+    return font;
+}
+
+GlyphAtlas::GlyphAtlas(std::shared_ptr<const Font> font, float pixel_height)
+    : m_font(std::move(font)), m_pixel_height(pixel_height) {
+    if (!m_font) {
+        throw tg_exception("GlyphAtlas needs a font");
+    }
+    const auto* info = &m_font->m_info->m_info;
+    m_scale          = stbtt_ScaleForPixelHeight(info, pixel_height);
+    int ascent       = 0;
+    int descent      = 0;
+    int line_gap     = 0;
+    stbtt_GetFontVMetrics(info, &ascent, &descent, &line_gap);
+    m_ascent      = static_cast<float>(ascent) * m_scale;
+    m_line_height = static_cast<float>(ascent - descent + line_gap) * m_scale;
+}
+
+auto GlyphAtlas::glyph(char32_t codepoint) -> const Glyph& {
+    if (auto it = m_glyphs.find(codepoint); it != m_glyphs.end()) {
+        return it->second;
+    }
+
+    const auto* info  = &m_font->m_info->m_info;
+    Glyph       glyph;
+    glyph.m_index     = stbtt_FindGlyphIndex(info, static_cast<int>(codepoint));
+    int advance       = 0;
+    int left_bearing  = 0;
+    stbtt_GetGlyphHMetrics(info, glyph.m_index, &advance, &left_bearing);
+    glyph.m_advance = static_cast<float>(advance) * m_scale;
+
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+    stbtt_GetGlyphBitmapBox(info, glyph.m_index, m_scale, m_scale, &x0, &y0, &x1, &y1);
+    glyph.m_width    = x1 - x0;
+    glyph.m_height   = y1 - y0;
+    glyph.m_offset_x = x0;
+    glyph.m_offset_y = y0;
+    if (glyph.m_width > 0 && glyph.m_height > 0) {
+        std::tie(glyph.m_page, glyph.m_x, glyph.m_y) = allocate(glyph.m_width, glyph.m_height);
+        auto* out = m_pages[static_cast<size_t>(glyph.m_page)].data() + static_cast<ptrdiff_t>(glyph.m_y) * k_page_size + glyph.m_x;
+        stbtt_MakeGlyphBitmap(info, out, glyph.m_width, glyph.m_height, k_page_size, m_scale, m_scale, glyph.m_index);
+    }
+    return m_glyphs.emplace(codepoint, glyph).first->second;
+}
+
+auto GlyphAtlas::kerning(const Glyph& left, const Glyph& right) const -> float {
+    return static_cast<float>(stbtt_GetGlyphKernAdvance(&m_font->m_info->m_info, left.m_index, right.m_index)) * m_scale;
+}
+
+auto GlyphAtlas::allocate(int width, int height) -> std::tuple<int, int, int> {
+    constexpr int k_padding = 1;   // 字形之间留空, 避免相邻字形的覆盖率互相影响
+    if (width + k_padding > k_page_size || height + k_padding > k_page_size) {
+        throw tg_exception("glyph too large: {}x{}", width, height);
+    }
+    // 当前行放不下时换行, 当前页放不下时开新页
+    if (m_shelf_x + width + k_padding > k_page_size) {
+        m_shelf_x       = 0;
+        m_shelf_y      += m_shelf_height;
+        m_shelf_height  = 0;
+    }
+    if (m_pages.empty() || m_shelf_y + height + k_padding > k_page_size) {
+        m_pages.emplace_back(static_cast<size_t>(k_page_size) * k_page_size, 0);
+        m_shelf_x      = 0;
+        m_shelf_y      = 0;
+        m_shelf_height = 0;
+    }
+    auto x          = m_shelf_x;
+    m_shelf_x      += width + k_padding;
+    m_shelf_height  = std::max(m_shelf_height, height + k_padding);
+    return {static_cast<int>(m_pages.size()) - 1, x, m_shelf_y};
+}
+
+auto TextBatch::add(GlyphAtlas& atlas, std::string_view utf8, const Point2& pos, const Color& color) -> void {
+    std::array<uint8_t, 3> bgr{color.get_b8(), color.get_g8(), color.get_r8()};
+    layout(atlas, utf8, pos, [&](const GlyphAtlas::Glyph& glyph, float x, float baseline) {
+        if (glyph.m_width == 0 || glyph.m_height == 0) {
+            return;
+        }
+        const auto* source = atlas.page(static_cast<size_t>(glyph.m_page)) + static_cast<ptrdiff_t>(glyph.m_y) * GlyphAtlas::k_page_size + glyph.m_x;
+        m_quads.push_back({
+            .m_source = source,
+            .m_x      = static_cast<int>(std::lround(x)) + glyph.m_offset_x,
+            .m_y      = static_cast<int>(std::lround(baseline)) + glyph.m_offset_y,
+            .m_width  = glyph.m_width,
+            .m_height = glyph.m_height,
+            .m_bgr    = bgr,
+        });
+    });
+}
+
+auto TextBatch::measure(GlyphAtlas& atlas, std::string_view utf8) -> Point2 {
+    float width = 0;
+    float lines = 1;
+    layout(atlas, utf8, Point2(0, 0), [&](const GlyphAtlas::Glyph& glyph, float x, float baseline) {
+        width = std::max(width, x + glyph.m_advance);
+        lines = std::max(lines, (baseline - atlas.ascent()) / atlas.lineHeight() + 1);
+    });
+    return {width, lines * atlas.lineHeight()};
+}
+
+auto TextBatch::draw(cv::Mat& image) -> void {
+    if (image.type() != CV_8UC3) {
+        throw tg_exception("TextBatch needs a CV_8UC3 image");
+    }
+    if (m_quads.empty() || image.rows == 0) {
+        m_quads.clear();
+        return;
+    }
+
+    // 每个字形放入它覆盖的行带, 各行带只写自己的行, 可以并行
+    auto bands = static_cast<size_t>((image.rows + k_band_rows - 1) / k_band_rows);
+    auto range = [&](const Quad& q) {
+        auto first = std::clamp(q.m_y, 0, image.rows - 1) / k_band_rows;
+        auto last  = std::clamp(q.m_y + q.m_height - 1, 0, image.rows - 1) / k_band_rows;
+        return std::pair{static_cast<size_t>(first), static_cast<size_t>(last)};
+    };
+    auto visible = [&](const Quad& q) {
+        return q.m_x < image.cols && q.m_x + q.m_width > 0 && q.m_y < image.rows && q.m_y + q.m_height > 0;
+    };
+    m_band_offsets.assign(bands + 1, 0);
+    for (const auto& q : m_quads) {
+        if (visible(q)) {
+            auto [first, last] = range(q);
+            for (auto b = first; b <= last; b++) {
+                m_band_offsets[b + 1]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < bands; b++) {
+        m_band_offsets[b + 1] += m_band_offsets[b];
+    }
+    m_band_quads.resize(m_band_offsets.back());
+    std::vector<size_t> cursor(m_band_offsets.begin(), m_band_offsets.end() - 1);
+    for (size_t i = 0; i < m_quads.size(); i++) {
+        if (visible(m_quads[i])) {
+            auto [first, last] = range(m_quads[i]);
+            for (auto b = first; b <= last; b++) {
+                m_band_quads[cursor[b]++] = i;
+            }
+        }
+    }
+
+    parallelFor(0, bands, 1, [&](size_t b, size_t e) {
+        for (auto band = b; band < e; band++) {
+            auto band_begin = static_cast<int>(band) * k_band_rows;
+            auto band_end   = std::min(band_begin + k_band_rows, image.rows);
+            for (auto k = m_band_offsets[band]; k < m_band_offsets[band + 1]; k++) {
+                const auto& q  = m_quads[m_band_quads[k]];
+                auto        y0 = std::max(q.m_y, band_begin);
+                auto        y1 = std::min(q.m_y + q.m_height, band_end);
+                auto        x0 = std::max(q.m_x, 0);
+                auto        x1 = std::min(q.m_x + q.m_width, image.cols);
+                for (auto y = y0; y < y1; y++) {
+                    const auto* src = q.m_source + static_cast<ptrdiff_t>(y - q.m_y) * GlyphAtlas::k_page_size - q.m_x;
+                    auto*       dst = image.ptr<uint8_t>(y);
+                    for (auto x = x0; x < x1; x++) {
+                        uint32_t a = src[x];
+                        if (a == 0) {
+                            continue;
+                        }
+                        auto* p = dst + static_cast<ptrdiff_t>(x) * 3;
+                        for (size_t c = 0; c < 3; c++) {
+                            p[c] = static_cast<uint8_t>((p[c] * (255 - a) + q.m_bgr[c] * a + 127) / 255);
+                        }
+                    }
+                }
+            }
+        }
+    });
+    m_quads.clear();
+}
+}   // namespace tg::render
@@ -0,0 +1,154 @@
+#pragma once
+#include <tg/Color.h>
+#include <tg/Point.h>
+
+#include <filesystem>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <unordered_map>
+
+namespace tg::render {
+// 字体文件 (ttf, ttc), 使用 stb_truetype 解析
+class Font {
+public:
+    // index 为 ttc 字体集合中的字体序号, 加载失败时抛出异常
+    explicit Font(const std::filesystem::path& path, int index = 0);
+    ~Font();
+
+    Font(const Font&)           = delete;
+    Font(Font&&)                = delete;
+    auto operator=(const Font&) = delete;
+    auto operator=(Font&&)      = delete;
+
+    // 系统自带的中文字体 (与界面使用的字体相同), 第一次调用时加载, 找不到时抛出异常
+    static auto getDefault() -> std::shared_ptr<const Font>;
+
+    auto path() const -> const std::filesystem::path& {
+        return m_path;
+    }
+
+private:
+    friend class GlyphAtlas;
+
+    struct Info;
+
+    std::filesystem::path      m_path;
+    std::vector<unsigned char> m_data;
+    std::unique_ptr<Info>      m_info;
+};
+
+// 一种字体一个字号的字形缓存.
+// 字形在第一次使用时光栅化为 8 位覆盖率, 用 shelf 方式装入固定大小的图集页, 之后直接复用.
+// 中文字符数量很多, 所以不预先光栅化整个字符集
+class GlyphAtlas {
+public:
+    static constexpr int k_page_size = 1024;
+
+    struct Glyph {
+        int   m_page     = 0;
+        int   m_x        = 0;   // 在图集页中的位置
+        int   m_y        = 0;
+        int   m_width    = 0;
+        int   m_height   = 0;
+        int   m_offset_x = 0;   // 位图左上角相对基线起点的偏移
+        int   m_offset_y = 0;
+        float m_advance  = 0;
+        int   m_index    = 0;   // 字体中的字形序号, 用于字距调整
+    };
+
+    GlyphAtlas(std::shared_ptr<const Font> font, float pixel_height);
+
+    // 光栅化 (如果还没有) 并返回字形, 返回的引用在图集的生命周期内有效
+    auto glyph(char32_t codepoint) -> const Glyph&;
+
+    auto kerning(const Glyph& left, const Glyph& right) const -> float;
+
+    auto pixelHeight() const {
+        return m_pixel_height;
+    }
+
+    // 基线以上的高度
+    auto ascent() const {
+        return m_ascent;
+    }
+
+    auto lineHeight() const {
+        return m_line_height;
+    }
+
+    // 第 i 页的覆盖率数据, k_page_size * k_page_size
+    auto page(size_t i) const -> const uint8_t* {
+        return m_pages[i].data();
+    }
+
+    auto pageCount() const {
+        return m_pages.size();
+    }
+
+    auto glyphCount() const {
+        return m_glyphs.size();
+    }
+
+private:
+    auto allocate(int width, int height) -> std::tuple<int, int, int>;
+
+    std::shared_ptr<const Font>         m_font;
+    float                               m_pixel_height;
+    float                               m_scale        = 0;
+    float                               m_ascent       = 0;
+    float                               m_line_height  = 0;
+    std::unordered_map<char32_t, Glyph> m_glyphs;
+    std::vector<std::vector<uint8_t>>   m_pages;
+    int                                 m_shelf_x      = 0;   // 当前 shelf (最后一页中的一行) 的下一个空闲位置
+    int                                 m_shelf_y      = 0;
+    int                                 m_shelf_height = 0;
+};
+
+// 一帧中的多个文字标签.
+// add 时完成排版 (并光栅化新出现的字形), draw 时把所有字形按行分带, 各带在线程池中并行混合到图像上.
+// draw 之前图集不能被销毁
+class TextBatch {
+public:
+    // pos 为文字左上角, 文字中的 '\n' 换行
+    auto add(GlyphAtlas& atlas, std::string_view utf8, const Point2& pos, const Color& color) -> void;
+
+    // 文字的宽和高
+    static auto measure(GlyphAtlas& atlas, std::string_view utf8) -> Point2;
+
+    // 绘制到 CV_8UC3 图像, 之后清空
+    auto draw(cv::Mat& image) -> void;
+
+    auto clear() -> void {
+        m_quads.clear();
+    }
+
+    auto empty() const {
+        return m_quads.empty();
+    }
+
+    // 待绘制的字形数
+    auto size() const {
+        return m_quads.size();
+    }
+
+    auto memoryBytes() const {
+        return m_quads.capacity() * sizeof(Quad) + (m_band_offsets.capacity() + m_band_quads.capacity()) * sizeof(size_t);
+    }
+
+private:
+    static constexpr int k_band_rows = 32;
+
+    struct Quad {
+        const uint8_t*         m_source;   // 图集页中字形左上角
+        int                    m_x;        // 在目标图像中的位置
+        int                    m_y;
+        int                    m_width;
+        int                    m_height;
+        std::array<uint8_t, 3> m_bgr;
+    };
+
+    std::vector<Quad>   m_quads;
+    std::vector<size_t> m_band_offsets;
+    std::vector<size_t> m_band_quads;
+};
+}   // namespace tg::render
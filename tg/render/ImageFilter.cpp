@@ -0,0 +1,304 @@
+#include <tg/parallel.h>
+#include <tg/render/ImageFilter.h>
+
+#include <numeric>
+
+namespace tg::render {
+namespace {
+constexpr int    k_channels = 3;
+constexpr size_t k_lut_size = 1024;
+
+// 每个线程的条带缓冲, 在多次调用之间复用
+class StripBuffers {
+public:
+    // rows 行, 每行 stride 个 float
+    auto prepare(size_t rows, size_t stride, size_t max_radius) -> void {
+        m_stride = stride;
+        for (auto& i : m_planes) {
+            i.resize(rows * stride);
+        }
+        m_padded.resize(stride + 2 * max_radius * k_channels);
+    }
+
+    auto row(size_t plane, size_t i) -> float* {
+        return m_planes[plane].data() + i * m_stride;
+    }
+
+    // 水平卷积, 原地. 先复制到两侧按边缘像素填充的临时行, 每个抽头是对连续内存的乘加, 可以向量化
+    auto convolveRow(float* row, const std::vector<float>& kernel) -> void {
+        auto  radius = kernel.size() / 2;
+        auto  pad    = radius * k_channels;
+        auto* tmp    = m_padded.data();
+        std::copy_n(row, m_stride, tmp + pad);
+        for (size_t i = 0; i < radius; i++) {
+            std::copy_n(row, k_channels, tmp + i * k_channels);
+            std::copy_n(row + m_stride - k_channels, k_channels, tmp + pad + m_stride + i * k_channels);
+        }
+        std::fill_n(row, m_stride, 0.F);
+        for (size_t k = 0; k < kernel.size(); k++) {
+            auto        w   = kernel[k];
+            const auto* src = tmp + k * k_channels;
+            for (size_t j = 0; j < m_stride; j++) {
+                row[j] += w * src[j];
+            }
+        }
+    }
+
+    // 竖直卷积: out = sum(kernel[k] * rows[k])
+    auto convolveColumn(float* out, size_t plane, size_t first, const std::vector<float>& kernel) -> void {
+        std::fill_n(out, m_stride, 0.F);
+        for (size_t k = 0; k < kernel.size(); k++) {
+            auto        w   = kernel[k];
+            const auto* src = row(plane, first + k);
+            for (size_t j = 0; j < m_stride; j++) {
+                out[j] += w * src[j];
+            }
+        }
+    }
+
+private:
+    size_t                            m_stride = 0;
+    std::array<std::vector<float>, 3> m_planes;
+    std::vector<float>                m_padded;
+};
+
+thread_local StripBuffers t_buffers;
+
+auto normalized(std::vector<float> kernel) -> std::vector<float> {
+    auto sum = std::accumulate(kernel.begin(), kernel.end(), 0.F);
+    for (auto& i : kernel) {
+        i /= sum;
+    }
+    return kernel;
+}
+
+auto gaussianKernel(float sigma) -> std::vector<float> {
+    auto               radius = std::max(static_cast<int>(std::ceil(3 * sigma)), 1);
+    std::vector<float> kernel(static_cast<size_t>(radius) * 2 + 1);
+    for (int i = -radius; i <= radius; i++) {
+        kernel[static_cast<size_t>(i + radius)] = std::exp(-static_cast<float>(i * i) / (2 * sigma * sigma));
+    }
+    return normalized(std::move(kernel));
+}
+}   // namespace
+
+auto FilterPipeline::gaussianBlur(float sigma) -> FilterPipeline& {
+    if (!(sigma > 0)) {
+        throw tg_exception("gaussian blur sigma must be positive: {}", sigma);
+    }
+    m_filters.push_back({.m_type = FilterType::Blur, .m_kernel = gaussianKernel(sigma)});
+    return *this;
+}
+
+auto FilterPipeline::boxBlur(int radius) -> FilterPipeline& {
+    if (radius <= 0) {
+        throw tg_exception("box blur radius must be positive: {}", radius);
+    }
+    m_filters.push_back({.m_type = FilterType::Blur, .m_kernel = normalized(std::vector<float>(static_cast<size_t>(radius) * 2 + 1, 1.F))});
+    return *this;
+}
+
+auto FilterPipeline::sharpen(float amount, float sigma) -> FilterPipeline& {
+    if (!(sigma > 0)) {
+        throw tg_exception("sharpen sigma must be positive: {}", sigma);
+    }
+    m_filters.push_back({.m_type = FilterType::Sharpen, .m_kernel = gaussianKernel(sigma), .m_value = amount});
+    return *this;
+}
+
+auto FilterPipeline::threshold(float value) -> FilterPipeline& {
+    m_filters.push_back({.m_type = FilterType::Threshold, .m_value = value});
+    return *this;
+}
+
+auto FilterPipeline::colorMatrix(const std::array<float, 12>& matrix) -> FilterPipeline& {
+    m_filters.push_back({.m_type = FilterType::ColorMatrix, .m_matrix = matrix});
+    return *this;
+}
+
+auto FilterPipeline::gamma(float gamma) -> FilterPipeline& {
+    if (!(gamma > 0)) {
+        throw tg_exception("gamma must be positive: {}", gamma);
+    }
+    // 最后多一项, 插值时不需要判断边界
+    std::vector<float> lut(k_lut_size + 1);
+    for (size_t i = 0; i < k_lut_size; i++) {
+        lut[i] = 255.F * std::pow(static_cast<float>(i) / static_cast<float>(k_lut_size - 1), gamma);
+    }
+    lut[k_lut_size] = lut[k_lut_size - 1];
+    m_filters.push_back({.m_type = FilterType::Gamma, .m_lut = std::move(lut)});
+    return *this;
+}
+
+auto FilterPipeline::radius() const -> int {
+    int res = 0;
+    for (const auto& i : m_filters) {
+        res += i.radius();
+    }
+    return res;
+}
+
+auto FilterPipeline::apply(cv::Mat& image) -> void {
+    if (radius() == 0) {
+        // 逐像素滤波, 每个条带只读写自己的行
+        run(image, image);
+        return;
+    }
+    run(image, m_scratch);
+    // 复制而不是交换, image 可能是 ROI 或与其它 cv::Mat 共享像素
+    m_scratch.copyTo(image);
+}
+
+auto FilterPipeline::apply(const cv::Mat& src, cv::Mat& dst) const -> void {
+    if (src.data != nullptr && src.data == dst.data) {
+        throw tg_exception("FilterPipeline::apply: src and dst share data");
+    }
+    run(src, dst);
+}
+
+auto FilterPipeline::run(const cv::Mat& src, cv::Mat& dst) const -> void {
+    if (src.type() != CV_8UC3) {
+        throw tg_exception("FilterPipeline needs a CV_8UC3 image");
+    }
+    if (dst.data != src.data && (dst.rows != src.rows || dst.cols != src.cols || dst.type() != CV_8UC3)) {
+        dst.create(src.rows, src.cols, CV_8UC3);
+    }
+    if (src.rows == 0 || src.cols == 0) {
+        return;
+    }
+
+    int max_radius = 0;
+    for (const auto& i : m_filters) {
+        max_radius = std::max(max_radius, i.radius());
+    }
+    auto total      = radius();
+    auto rows       = src.rows;
+    auto stride     = static_cast<size_t>(src.cols) * k_channels;
+    auto strip_rows = std::max(k_strip_rows, total * 4);
+    auto strips     = static_cast<size_t>((rows + strip_rows - 1) / strip_rows);
+
+    parallelFor(0, strips, 1, [&](size_t b, size_t e) {
+        auto& buffers = t_buffers;
+        for (auto s = b; s < e; s++) {
+            auto y0 = static_cast<int>(s) * strip_rows;
+            auto y1 = std::min(y0 + strip_rows, rows);
+            auto lo = y0 - total;   // 缓冲第 0 行对应的图像行
+            auto n  = static_cast<size_t>(y1 - y0 + 2 * total);
+            buffers.prepare(n, stride, static_cast<size_t>(max_radius));
+
+            for (size_t i = 0; i < n; i++) {
+                auto        y   = std::clamp(lo + static_cast<int>(i), 0, rows - 1);
+                const auto* in  = src.ptr<uint8_t>(y);
+                auto*       out = buffers.row(0, i);
+                for (size_t j = 0; j < stride; j++) {
+                    out[j] = in[j];
+                }
+            }
+
+            // current 为当前结果所在的平面, 有效行为 [valid_begin, valid_end); 每个邻域滤波使有效范围两端各减少半径行
+            size_t valid_begin = 0;
+            size_t valid_end   = n;
+            size_t current     = 0;
+            auto   next        = [&current](size_t k) { return (current + k) % 3; };
+            for (const auto& f : m_filters) {
+                auto r = static_cast<size_t>(f.radius());
+                switch (f.m_type) {
+                    case FilterType::Blur: {
+                        for (auto i = valid_begin; i < valid_end; i++) {
+                            buffers.convolveRow(buffers.row(current, i), f.m_kernel);
+                        }
+                        for (auto i = valid_begin + r; i < valid_end - r; i++) {
+                            buffers.convolveColumn(buffers.row(next(1), i), current, i - r, f.m_kernel);
+                        }
+                        current = next(1);
+                        break;
+                    }
+                    case FilterType::Sharpen: {
+                        // 模糊结果写入另一个平面, 原图保留用于相减
+                        auto blurred = next(1);
+                        auto result  = next(2);
+                        for (auto i = valid_begin; i < valid_end; i++) {
+                            auto* row = buffers.row(blurred, i);
+                            std::copy_n(buffers.row(current, i), stride, row);
+                            buffers.convolveRow(row, f.m_kernel);
+                        }
+                        for (auto i = valid_begin + r; i < valid_end - r; i++) {
+                            auto*       out = buffers.row(result, i);
+                            const auto* in  = buffers.row(current, i);
+                            buffers.convolveColumn(out, blurred, i - r, f.m_kernel);
+                            for (size_t j = 0; j < stride; j++) {
+                                out[j] = in[j] + f.m_value * (in[j] - out[j]);
+                            }
+                        }
+                        current = result;
+                        break;
+                    }
+                    case FilterType::ColorMatrix: {
+                        const auto& m = f.m_matrix;
+                        for (auto i = valid_begin; i < valid_end; i++) {
+                            auto* p = buffers.row(current, i);
+                            for (size_t j = 0; j < stride; j += k_channels) {
+                                auto bb  = p[j];
+                                auto gg  = p[j + 1];
+                                auto rr  = p[j + 2];
+                                p[j]     = m[8] * rr + m[9] * gg + m[10] * bb + m[11];
+                                p[j + 1] = m[4] * rr + m[5] * gg + m[6] * bb + m[7];
+                                p[j + 2] = m[0] * rr + m[1] * gg + m[2] * bb + m[3];
+                            }
+                        }
+                        break;
+                    }
+                    case FilterType::Threshold: {
+                        for (auto i = valid_begin; i < valid_end; i++) {
+                            auto* p = buffers.row(current, i);
+                            for (size_t j = 0; j < stride; j += k_channels) {
+                                auto luma = 0.114F * p[j] + 0.587F * p[j + 1] + 0.299F * p[j + 2];
+                                auto v    = luma >= f.m_value ? 255.F : 0.F;
+                                p[j]      = v;
+                                p[j + 1]  = v;
+                                p[j + 2]  = v;
+                            }
+                        }
+                        break;
+                    }
+                    case FilterType::Gamma: {
+                        constexpr auto k_scale = static_cast<float>(k_lut_size - 1) / 255.F;
+                        const auto*    lut     = f.m_lut.data();
+                        for (auto i = valid_begin; i < valid_end; i++) {
+                            auto* p = buffers.row(current, i);
+                            for (size_t j = 0; j < stride; j++) {
+                                auto x    = std::clamp(p[j], 0.F, 255.F) * k_scale;
+                                auto k    = static_cast<size_t>(x);
+                                auto frac = x - static_cast<float>(k);
+                                p[j]      = lut[k] + frac * (lut[k + 1] - lut[k]);
+                            }
+                        }
+                        break;
+                    }
+                }
+                valid_begin += r;
+                valid_end   -= r;
+
+                // 图像外的行重新复制边缘行, 使下一个滤波看到的边界与单独执行时相同
+                if (r > 0) {
+                    for (auto i = valid_begin; i < valid_end; i++) {
+                        auto y = lo + static_cast<int>(i);
+                        if (y < 0 || y >= rows) {
+                            auto edge = static_cast<size_t>(std::clamp(y, 0, rows - 1) - lo);
+                            std::copy_n(buffers.row(current, edge), stride, buffers.row(current, i));
+                        }
+                    }
+                }
+            }
+
+            for (auto y = y0; y < y1; y++) {
+                const auto* in  = buffers.row(current, static_cast<size_t>(y - lo));
+                auto*       out = dst.ptr<uint8_t>(y);
+                for (size_t j = 0; j < stride; j++) {
+                    out[j] = static_cast<uint8_t>(std::clamp(in[j] + 0.5F, 0.F, 255.F));
+                }
+            }
+        }
+    });
+}
+}   // namespace tg::render
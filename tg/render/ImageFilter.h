@@ -0,0 +1,86 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <array>
+#include <opencv2/opencv.hpp>
+
+namespace tg::render {
+// CV_8UC3 (BGR) 图像的滤波流水线.
+// 所有滤波融合在一起按行条带执行: 每个条带 (加上邻域滤波需要的上下额外行) 转换为 float 后依次经过全部滤波,
+// 中间结果只存在于线程自己的条带缓冲中, 不会为每个滤波分配整张图像, 也不会多次读写整张图像.
+// 条带在线程池中并行处理. 边界按复制边缘像素处理, 与逐个滤波整图执行的结果一致.
+//
+//  render::FilterPipeline pipeline;
+//  pipeline.gaussianBlur(2).sharpen(0.5F).gamma(0.8F);
+//  pipeline.apply(image);
+class FilterPipeline {
+public:
+    static constexpr int k_strip_rows = 32;   // 条带的最小行数, 邻域较大时增加以减少重复计算的比例
+
+    // 可分离高斯模糊, 半径为 ceil(3 * sigma)
+    auto gaussianBlur(float sigma) -> FilterPipeline&;
+
+    // 可分离均值模糊, 窗口为 (2 * radius + 1)^2
+    auto boxBlur(int radius) -> FilterPipeline&;
+
+    // 反锐化掩模: 输出 = 输入 + amount * (输入 - 高斯模糊(输入))
+    auto sharpen(float amount, float sigma = 1) -> FilterPipeline&;
+
+    // 亮度不小于 value (0 ~ 255) 的像素变为白色, 其余为黑色
+    auto threshold(float value) -> FilterPipeline&;
+
+    // 颜色矩阵, 按 RGB 顺序的 3x4 行优先矩阵, 输出 = M * (r, g, b, 1), 颜色值范围 0 ~ 255
+    auto colorMatrix(const std::array<float, 12>& matrix) -> FilterPipeline&;
+
+    // 输出 = 255 * (输入 / 255)^gamma
+    auto gamma(float gamma) -> FilterPipeline&;
+
+    auto clear() -> void {
+        m_filters.clear();
+    }
+
+    auto empty() const {
+        return m_filters.empty();
+    }
+
+    auto size() const {
+        return m_filters.size();
+    }
+
+    // 所有滤波的邻域半径之和, 即每个条带上下需要额外读取的行数
+    auto radius() const -> int;
+
+    // 原地执行, 结果写回 image 的像素 (image 可以是 ROI, 共享这些像素的其它 cv::Mat 都能看到结果).
+    // 只有逐像素滤波时直接写回; 有邻域滤波时先写入内部缓冲再复制回 image, 缓冲在多次调用之间复用
+    auto apply(cv::Mat& image) -> void;
+
+    // 结果写入 dst, dst 尺寸不同时重新分配; dst 不能与 src 共享数据
+    auto apply(const cv::Mat& src, cv::Mat& dst) const -> void;
+
+private:
+    enum class FilterType : uint8_t {
+        Blur,
+        Sharpen,
+        ColorMatrix,
+        Threshold,
+        Gamma,
+    };
+
+    struct Filter {
+        FilterType            m_type;
+        std::vector<float>    m_kernel{};    // Blur, Sharpen: 2 * 半径 + 1 个权重
+        std::array<float, 12> m_matrix{};    // ColorMatrix
+        float                 m_value = 0;   // Sharpen: amount, Threshold: 阈值
+        std::vector<float>    m_lut{};       // Gamma: [0, 255] 上等间距采样
+
+        auto radius() const -> int {
+            return static_cast<int>(m_kernel.size() / 2);
+        }
+    };
+
+    auto run(const cv::Mat& src, cv::Mat& dst) const -> void;
+
+    std::vector<Filter> m_filters;
+    cv::Mat             m_scratch;
+};
+}   // namespace tg::render
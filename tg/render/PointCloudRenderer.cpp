@@ -0,0 +1,339 @@
+#include <tg/parallel.h>
+#include <tg/render/PointCloudRenderer.h>
+
+namespace tg::render {
+namespace {
+constexpr int    k_morton_bits = 21;
+constexpr size_t k_grain       = 1 << 16;
+
+// 把 21 位整数的每一位间隔两位展开
+constexpr auto splitBits3(uint64_t v) -> uint64_t {
+    v &= (1ULL << k_morton_bits) - 1;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+constexpr auto morton(uint32_t x, uint32_t y, uint32_t z) -> uint64_t {
+    return splitBits3(x) | (splitBits3(y) << 1) | (splitBits3(z) << 2);
+}
+
+auto elapsedNs(std::chrono::steady_clock::time_point start) -> int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 分块排序后两两归并
+template <typename T>
+auto parallelSort(std::vector<T>& v) -> void {
+    auto chunks = ThreadPool::getInstance().threadCount() + 1;
+    auto size   = (v.size() + chunks - 1) / chunks;
+    if (chunks == 1 || size < k_grain) {
+        std::ranges::sort(v);
+        return;
+    }
+    parallelFor(0, v.size(), size, [&](size_t b, size_t e) {
+        std::sort(v.begin() + static_cast<ptrdiff_t>(b), v.begin() + static_cast<ptrdiff_t>(e));
+    });
+    for (; size < v.size(); size *= 2) {
+        parallelFor(0, v.size(), size * 2, [&](size_t b, size_t e) {
+            auto m = std::min(b + size, e);
+            std::inplace_merge(v.begin() + static_cast<ptrdiff_t>(b), v.begin() + static_cast<ptrdiff_t>(m), v.begin() + static_cast<ptrdiff_t>(e));
+        });
+    }
+}
+}   // namespace
+
+auto PointOctree::build(std::vector<Point3> points) -> void {
+    m_nodes.clear();
+    m_bounds = {};
+    if (points.empty()) {
+        m_points.clear();
+        return;
+    }
+    if (points.size() > std::numeric_limits<uint32_t>::max()) {
+        throw tg_exception("too many points: {}", points.size());
+    }
+
+    std::mutex mutex;
+    parallelFor(0, points.size(), k_grain, [&](size_t b, size_t e) {
+        Bounds3 local;
+        for (auto i = b; i < e; i++) {
+            local.expand(points[i]);
+        }
+        std::scoped_lock lock(mutex);
+        m_bounds.expand(local);
+    });
+
+    // 包围盒扩展为立方体, 每个轴分为 2^21 格
+    auto extent = m_bounds.m_max - m_bounds.m_min;
+    auto size   = std::max({extent.x, extent.y, extent.z, std::numeric_limits<float>::min()});
+    auto cells  = static_cast<float>(1U << k_morton_bits);
+    auto scale  = (cells - 1) / size;
+    auto origin = m_bounds.m_min;
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys(points.size());
+    parallelFor(0, points.size(), k_grain, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            auto cell = [&](size_t axis) { return static_cast<uint32_t>((points[i][axis] - origin[axis]) * scale); };
+            keys[i]   = {morton(cell(0), cell(1), cell(2)), static_cast<uint32_t>(i)};
+        }
+    });
+    parallelSort(keys);
+
+    m_points.resize(points.size());
+    parallelFor(0, points.size(), k_grain, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            m_points[i] = points[keys[i].second];
+        }
+    });
+    points = {};
+
+    // 子节点在 Morton 码中占 3 位, 同一节点的点码的高位相同, 按这 3 位即可划分
+    auto half_root = size / 2;
+    m_nodes.push_back({
+        .m_center = origin + Point3(half_root, half_root, half_root),
+        .m_radius = half_root * std::numbers::sqrt3_v<float>,
+        .m_begin  = 0,
+        .m_end    = static_cast<uint32_t>(m_points.size()),
+    });
+    std::vector<size_t> stack{0};
+    while (!stack.empty()) {
+        auto index = stack.back();
+        auto node  = m_nodes[index];
+        stack.pop_back();
+        if (node.count() <= k_leaf_size || node.m_depth >= k_max_depth) {
+            continue;
+        }
+        auto shift = 3 * (k_morton_bits - 1 - node.m_depth);
+        auto half  = node.m_radius / std::numbers::sqrt3_v<float> / 2;
+        auto first = m_nodes.size();
+        auto begin = keys.begin() + node.m_begin;
+        auto end   = keys.begin() + node.m_end;
+        for (uint32_t c = 0; c < 8 && begin != end; c++) {
+            auto next = std::partition_point(begin, end, [&](auto& k) { return ((k.first >> shift) & 7) <= c; });
+            if (next != begin) {
+                auto offset = Point3((c & 1) != 0 ? half : -half, (c & 2) != 0 ? half : -half, (c & 4) != 0 ? half : -half);
+                m_nodes.push_back({
+                    .m_center = node.m_center + offset,
+                    .m_radius = node.m_radius / 2,
+                    .m_begin  = static_cast<uint32_t>(begin - keys.begin()),
+                    .m_end    = static_cast<uint32_t>(next - keys.begin()),
+                    .m_depth  = static_cast<uint8_t>(node.m_depth + 1),
+                });
+                stack.push_back(m_nodes.size() - 1);
+            }
+            begin = next;
+        }
+        m_nodes[index].m_first_child = static_cast<uint32_t>(first);
+        m_nodes[index].m_child_count = static_cast<uint8_t>(m_nodes.size() - first);
+    }
+}
+
+auto PointCloudRenderer::setPoints(std::vector<Point3> points) -> void {
+    m_octree.build(std::move(points));
+
+    // 蓝 -> 青 -> 绿 -> 黄 -> 红
+    const std::array<Color, 5> k_gradient{constants::blue, constants::cyan, constants::green, constants::yellow, constants::red};
+    for (size_t i = 0; i < m_palette.size(); i++) {
+        auto t       = static_cast<float>(i) / static_cast<float>(m_palette.size() - 1) * static_cast<float>(k_gradient.size() - 1);
+        auto k       = std::min(static_cast<size_t>(t), k_gradient.size() - 2);
+        auto c       = k_gradient[k] + (k_gradient[k + 1] - k_gradient[k]) * (t - static_cast<float>(k));
+        m_palette[i] = cv::Vec3b(c.get_b8(), c.get_g8(), c.get_r8());
+    }
+}
+
+auto PointCloudRenderer::selectNodes(const OrbitCamera& camera, int width, int height) -> void {
+    m_draws.clear();
+    auto nodes = m_octree.nodes();
+    if (nodes.empty()) {
+        return;
+    }
+
+    auto eye     = camera.eye();
+    auto forward = (camera.m_target - eye).normalized();
+    auto right   = forward.cross(Point3(0, 1, 0)).normalized();
+    auto up      = right.cross(forward);
+    auto focal   = static_cast<float>(height) / 2 / std::tan(camera.m_fov / 2);
+    auto w       = static_cast<float>(width);
+    auto h       = static_cast<float>(height);
+
+    // 先按每个节点需要的点数选择, 超出预算时所有节点按比例减少
+    size_t              wanted = 0;
+    std::vector<size_t> stack{0};
+    while (!stack.empty()) {
+        const auto& node = nodes[stack.back()];
+        stack.pop_back();
+
+        auto d = node.m_center - eye;
+        auto z = d.dot(forward);
+        if (z + node.m_radius < camera.m_near) {
+            continue;
+        }
+        auto leaf = node.m_child_count == 0;
+        if (z - node.m_radius > camera.m_near) {
+            auto r  = focal * node.m_radius / (z - node.m_radius);
+            auto sx = w / 2 + focal * d.dot(right) / z;
+            auto sy = h / 2 - focal * d.dot(up) / z;
+            if (sx + r < 0 || sx - r > w || sy + r < 0 || sy - r > h) {
+                continue;
+            }
+            // 投影很小的节点按覆盖的像素数抽样, 大约每个像素一个点
+            if (auto diameter = 2 * r; leaf || diameter < k_lod_node_pixels) {
+                auto count = leaf && diameter >= k_lod_node_pixels ? node.count() : std::min<size_t>(node.count(), std::max<size_t>(1, static_cast<size_t>(diameter * diameter)));
+                m_draws.push_back({node.m_begin, node.count(), static_cast<uint32_t>(count), 1});
+                wanted += count;
+                continue;
+            }
+        }
+        else if (leaf) {
+            m_draws.push_back({node.m_begin, node.count(), node.count(), 1});
+            wanted += node.count();
+            continue;
+        }
+        for (uint32_t i = 0; i < node.m_child_count; i++) {
+            stack.push_back(node.m_first_child + i);
+        }
+    }
+
+    auto ratio = wanted > m_point_budget ? static_cast<double>(m_point_budget) / static_cast<double>(wanted) : 1.;
+    for (auto& draw : m_draws) {
+        draw.m_count = std::max<uint32_t>(1, static_cast<uint32_t>(static_cast<double>(draw.m_count) * ratio));
+        draw.m_step  = static_cast<float>(draw.m_size) / static_cast<float>(draw.m_count);
+    }
+}
+
+auto PointCloudRenderer::render(cv::Mat& image, const OrbitCamera& camera, const Color& background) -> Stats {
+    Stats stats;
+    stats.m_total_points = m_octree.points().size();
+    auto width           = image.cols;
+    auto height          = image.rows;
+    if (image.empty() || image.type() != CV_8UC3) {
+        throw tg_exception("point cloud renderer needs a CV_8UC3 image");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    selectNodes(camera, width, height);
+    stats.m_select_ns = elapsedNs(start);
+    stats.m_nodes     = m_draws.size();
+
+    // 按点数把选中的节点分成投影任务
+    m_jobs.clear();
+    for (size_t i = 0, points = 0; i < m_draws.size(); i++) {
+        if (m_jobs.empty() || points >= k_job_points) {
+            m_jobs.emplace_back().m_first_draw = i;
+            points                             = 0;
+        }
+        m_jobs.back().m_draw_count++;
+        points += m_draws[i].m_count;
+        stats.m_drawn_points += m_draws[i].m_count;
+    }
+
+    auto tiles_x = (width + k_tile_size - 1) / k_tile_size;
+    auto tiles_y = (height + k_tile_size - 1) / k_tile_size;
+    auto tiles   = static_cast<size_t>(tiles_x * tiles_y);
+
+    // 投影: 每个任务独立输出按 tile 排序的点, 不需要同步
+    start        = std::chrono::steady_clock::now();
+    auto points  = m_octree.points();
+    auto eye     = camera.eye();
+    auto forward = (camera.m_target - eye).normalized();
+    auto right   = forward.cross(Point3(0, 1, 0)).normalized();
+    auto up      = right.cross(forward);
+    auto focal   = static_cast<float>(height) / 2 / std::tan(camera.m_fov / 2);
+    auto min_y   = m_octree.bounds().m_min.y;
+    auto inv_y   = static_cast<float>(m_palette.size() - 1) / std::max(m_octree.bounds().m_max.y - min_y, std::numeric_limits<float>::min());
+    parallelFor(0, m_jobs.size(), 1, [&](size_t b, size_t e) {
+        std::vector<Splat>    splats;
+        std::vector<uint32_t> splat_tiles;
+        for (auto j = b; j < e; j++) {
+            auto& job = m_jobs[j];
+            splats.clear();
+            splat_tiles.clear();
+            for (auto& draw : std::span(m_draws).subspan(job.m_first_draw, job.m_draw_count)) {
+                for (uint32_t k = 0; k < draw.m_count; k++) {
+                    const auto& p = points[draw.m_begin + static_cast<uint32_t>(static_cast<float>(k) * draw.m_step)];
+                    auto        d = p - eye;
+                    auto        z = d.dot(forward);
+                    if (z < camera.m_near) {
+                        continue;
+                    }
+                    auto sx = static_cast<float>(width) / 2 + focal * d.dot(right) / z;
+                    auto sy = static_cast<float>(height) / 2 - focal * d.dot(up) / z;
+                    if (!(sx >= 0 && sx < static_cast<float>(width) && sy >= 0 && sy < static_cast<float>(height))) {
+                        continue;
+                    }
+                    auto x     = static_cast<uint16_t>(sx);
+                    auto y     = static_cast<uint16_t>(sy);
+                    auto color = static_cast<uint32_t>(std::clamp((p.y - min_y) * inv_y, 0.F, static_cast<float>(m_palette.size() - 1)));
+                    splats.push_back({x, y, z, color});
+                    splat_tiles.push_back(static_cast<uint32_t>((y / k_tile_size) * tiles_x + x / k_tile_size));
+                }
+            }
+
+            // 按 tile 计数排序
+            job.m_tile_offsets.assign(tiles + 1, 0);
+            for (auto t : splat_tiles) {
+                job.m_tile_offsets[t + 1]++;
+            }
+            for (size_t t = 0; t < tiles; t++) {
+                job.m_tile_offsets[t + 1] += job.m_tile_offsets[t];
+            }
+            job.m_splats.resize(splats.size());
+            auto cursor = std::vector<uint32_t>(job.m_tile_offsets.begin(), job.m_tile_offsets.end() - 1);
+            for (size_t i = 0; i < splats.size(); i++) {
+                job.m_splats[cursor[splat_tiles[i]]++] = splats[i];
+            }
+        }
+    });
+    stats.m_project_ns = elapsedNs(start);
+
+    // 光栅化: 每个 tile 由一个线程处理, 深度缓冲和图像的写入互不重叠
+    start = std::chrono::steady_clock::now();
+    m_depth.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    auto bg = cv::Vec3b(background.get_b8(), background.get_g8(), background.get_r8());
+    parallelFor(0, tiles, 1, [&](size_t b, size_t e) {
+        for (auto t = b; t < e; t++) {
+            auto x0 = static_cast<int>(t % tiles_x) * k_tile_size;
+            auto y0 = static_cast<int>(t / tiles_x) * k_tile_size;
+            auto x1 = std::min(x0 + k_tile_size, width);
+            auto y1 = std::min(y0 + k_tile_size, height);
+            for (auto y = y0; y < y1; y++) {
+                auto* row = image.ptr<cv::Vec3b>(y);
+                std::fill(row + x0, row + x1, bg);
+                std::fill(m_depth.begin() + y * width + x0, m_depth.begin() + y * width + x1, std::numeric_limits<float>::infinity());
+            }
+            for (auto& job : m_jobs) {
+                for (auto i = job.m_tile_offsets[t]; i < job.m_tile_offsets[t + 1]; i++) {
+                    const auto& s     = job.m_splats[i];
+                    auto&       depth = m_depth[static_cast<size_t>(s.m_y) * static_cast<size_t>(width) + s.m_x];
+                    if (s.m_depth < depth) {
+                        depth                              = s.m_depth;
+                        image.ptr<cv::Vec3b>(s.m_y)[s.m_x] = m_palette[s.m_color];
+                    }
+                }
+            }
+        }
+    });
+    stats.m_raster_ns = elapsedNs(start);
+    return stats;
+}
+
+auto PointCloudRenderer::scratchBytes() const -> size_t {
+    auto bytes = m_draws.capacity() * sizeof(Draw) + m_jobs.capacity() * sizeof(Job) + m_depth.capacity() * sizeof(float);
+    for (const auto& j : m_jobs) {
+        bytes += j.m_splats.capacity() * sizeof(Splat) + j.m_tile_offsets.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+auto PointCloudRenderer::trim() -> size_t {
+    auto bytes = scratchBytes();
+    m_draws    = {};
+    m_jobs     = {};
+    m_depth    = {};
+    return bytes;
+}
+}   // namespace tg::render
@@ -0,0 +1,161 @@
+#pragma once
+#include <tg/Color.h>
+#include <tg/CompressedPoints.h>
+#include <tg/Point.h>
+
+#include <opencv2/opencv.hpp>
+
+namespace tg::render {
+// 围绕目标点旋转的相机, y 轴向上
+class OrbitCamera {
+public:
+    Point3 m_target;
+    float  m_yaw      = 0.6F;
+    float  m_pitch    = 0.5F;
+    float  m_distance = 100.F;
+    float  m_fov      = degreesToRadians(60.F);   // 垂直视角
+    float  m_near     = 0.1F;
+
+    auto eye() const -> Point3 {
+        return m_target + Point3(std::cos(m_pitch) * std::sin(m_yaw), std::sin(m_pitch), std::cos(m_pitch) * std::cos(m_yaw)) * m_distance;
+    }
+
+    // 鼠标拖动的像素数转换为旋转角度
+    auto rotate(float dx, float dy) -> void {
+        constexpr auto k_speed     = 0.01F;
+        constexpr auto k_max_pitch = 1.55F;
+        m_yaw -= dx * k_speed;
+        m_pitch = std::clamp(m_pitch + dy * k_speed, -k_max_pitch, k_max_pitch);
+    }
+
+    auto zoom(float factor) -> void {
+        m_distance = std::max(m_distance * factor, m_near * 2);
+    }
+
+    // 让相机看到整个包围盒
+    auto fit(const Bounds3& bounds) -> void {
+        m_target   = (bounds.m_min + bounds.m_max) / 2;
+        m_distance = std::max((bounds.m_max - bounds.m_min).length(), 1.F);
+    }
+};
+
+// 点云八叉树, 点按 Morton 码排序, 每个节点对应连续的一段点.
+// 同一节点内的点按空间顺序排列, 等间隔抽样即可得到空间上均匀的子集, 用于 LOD.
+class PointOctree {
+public:
+    class Node {
+    public:
+        Point3   m_center;
+        float    m_radius      = 0;   // 外接球半径
+        uint32_t m_begin       = 0;
+        uint32_t m_end         = 0;
+        uint32_t m_first_child = 0;   // 子节点连续存放
+        uint8_t  m_child_count = 0;
+        uint8_t  m_depth       = 0;
+
+        auto count() const {
+            return m_end - m_begin;
+        }
+    };
+
+    static constexpr size_t k_leaf_size = 4096;
+    static constexpr int    k_max_depth = 20;   // Morton 码每个轴 21 位
+
+    // 点的顺序会改变
+    auto build(std::vector<Point3> points) -> void;
+
+    auto points() const -> std::span<const Point3> {
+        return m_points;
+    }
+
+    auto nodes() const -> std::span<const Node> {
+        return m_nodes;
+    }
+
+    auto bounds() const -> const Bounds3& {
+        return m_bounds;
+    }
+
+    auto memoryBytes() const {
+        return m_points.capacity() * sizeof(Point3) + m_nodes.capacity() * sizeof(Node);
+    }
+
+private:
+    std::vector<Point3> m_points;
+    std::vector<Node>   m_nodes;
+    Bounds3             m_bounds;
+};
+
+// 多线程点云渲染: 按屏幕分块 (tile) 分桶后每块独立做深度测试, 块之间没有写冲突.
+// 每帧按八叉树 LOD 选择节点, 绘制的点数不超过 m_point_budget.
+class PointCloudRenderer {
+public:
+    class Stats {
+    public:
+        size_t  m_total_points = 0;
+        size_t  m_drawn_points = 0;   // 经过 LOD 抽样, 投影之前
+        size_t  m_nodes        = 0;   // 选中的八叉树节点
+        int64_t m_select_ns    = 0;
+        int64_t m_project_ns   = 0;
+        int64_t m_raster_ns    = 0;
+    };
+
+    static constexpr int    k_tile_size            = 64;
+    static constexpr size_t k_default_point_budget = 4'000'000;
+    static constexpr float  k_lod_node_pixels      = 32.F;    // 投影直径小于该值的节点不再细分
+    static constexpr size_t k_job_points           = 65536;   // 每个投影任务的点数
+
+    auto setPoints(std::vector<Point3> points) -> void;
+
+    auto octree() const -> const PointOctree& {
+        return m_octree;
+    }
+
+    // image 为 CV_8UC3
+    auto render(cv::Mat& image, const OrbitCamera& camera, const Color& background) -> Stats;
+
+    // 每帧复用的投影和深度缓冲
+    auto scratchBytes() const -> size_t;
+
+    // 释放投影和深度缓冲, 下一次 render 重新分配, 返回释放的字节数
+    auto trim() -> size_t;
+
+    size_t m_point_budget = k_default_point_budget;
+
+private:
+    // 选中的节点: 从 m_begin 开始的 m_size 个点中每隔 m_step 取一个点, 共 m_count 个
+    class Draw {
+    public:
+        uint32_t m_begin;
+        uint32_t m_size;
+        uint32_t m_count;
+        float    m_step;
+    };
+
+    // 投影后的点
+    class Splat {
+    public:
+        uint16_t m_x;
+        uint16_t m_y;
+        float    m_depth;
+        uint32_t m_color;   // 颜色表下标
+    };
+
+    // 一次投影任务的输出, 按 tile 排序
+    class Job {
+    public:
+        size_t                m_first_draw;
+        size_t                m_draw_count;
+        std::vector<Splat>    m_splats;
+        std::vector<uint32_t> m_tile_offsets;   // 大小为 tile 数 + 1
+    };
+
+    auto selectNodes(const OrbitCamera& camera, int width, int height) -> void;
+
+    PointOctree                m_octree;
+    std::array<cv::Vec3b, 256> m_palette{};   // 按高度着色
+    std::vector<Draw>          m_draws;
+    std::vector<Job>           m_jobs;
+    std::vector<float>         m_depth;
+};
+}   // namespace tg::render
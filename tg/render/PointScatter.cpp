@@ -0,0 +1,154 @@
+#include <tg/cpu.h>
+#include <tg/render/PointScatter.h>
+
+#include <array>
+#include <bit>
+
+namespace tg::render {
+namespace {
+static_assert(sizeof(PointInt2) == sizeof(int32_t) * 2 && std::is_standard_layout_v<PointInt2>, "PointInt2 is loaded as packed int pairs");
+
+// 目标图像, 偏移量 = y * step + x * 3
+class Target {
+public:
+    uint8_t*  m_data;
+    size_t    m_step;
+    int       m_width;
+    int       m_height;
+    PointInt2 m_origin;
+
+    template <typename ColorOf>
+    auto put(ColorOf& color, size_t i, size_t offset) const {
+        auto  c = color(i);
+        auto* p = m_data + offset;
+        p[0]    = c.b;
+        p[1]    = c.g;
+        p[2]    = c.r;
+    }
+};
+
+#if defined(TG_X86)
+// 按顺序写入 mask 中的点, 重叠的点与逐点绘制的结果相同
+template <typename ColorOf>
+auto putMasked(const Target& target, ColorOf& color, size_t first, uint32_t mask, const int32_t* offsets) {
+    for (; mask != 0; mask &= mask - 1) {
+        auto k = static_cast<size_t>(std::countr_zero(mask));
+        target.put(color, first + k, static_cast<size_t>(offsets[k]));
+    }
+}
+
+// 每次 16 个点, 返回处理的点数, 剩余的点由标量代码处理
+template <typename ColorOf>
+TG_TARGET_AVX512 auto scatterAvx512(const Target& target, std::span<const PointInt2> points, ColorOf& color, size_t& drawn) -> size_t {
+    const auto* src   = reinterpret_cast<const int32_t*>(points.data());   // NOLINT
+    const auto  even  = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const auto  odd   = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    const auto  ox    = _mm512_set1_epi32(target.m_origin.x);
+    const auto  oy    = _mm512_set1_epi32(target.m_origin.y);
+    const auto  w     = _mm512_set1_epi32(target.m_width);
+    const auto  h     = _mm512_set1_epi32(target.m_height);
+    const auto  step  = _mm512_set1_epi32(static_cast<int32_t>(target.m_step));
+    const auto  three = _mm512_set1_epi32(3);
+    alignas(64) std::array<int32_t, 16> offsets{};
+    size_t i = 0;
+    for (; i + 16 <= points.size(); i += 16) {
+        auto a = _mm512_loadu_si512(src + i * 2);
+        auto b = _mm512_loadu_si512(src + i * 2 + 16);
+        auto x = _mm512_sub_epi32(_mm512_permutex2var_epi32(a, even, b), ox);
+        auto y = _mm512_sub_epi32(_mm512_permutex2var_epi32(a, odd, b), oy);
+        // 无符号比较, 负数转换后一定不小于宽高
+        auto mask = static_cast<uint32_t>(_mm512_cmplt_epu32_mask(x, w) & _mm512_cmplt_epu32_mask(y, h));
+        if (mask == 0) {
+            continue;
+        }
+        _mm512_store_si512(offsets.data(), _mm512_add_epi32(_mm512_mullo_epi32(y, step), _mm512_mullo_epi32(x, three)));
+        drawn += static_cast<size_t>(std::popcount(mask));
+        putMasked(target, color, i, mask, offsets.data());
+    }
+    return i;
+}
+
+// 每次 8 个点
+template <typename ColorOf>
+TG_TARGET_AVX2 auto scatterAvx2(const Target& target, std::span<const PointInt2> points, ColorOf& color, size_t& drawn) -> size_t {
+    const auto* src          = reinterpret_cast<const int32_t*>(points.data());   // NOLINT
+    const auto  deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const auto  ox           = _mm256_set1_epi32(target.m_origin.x);
+    const auto  oy           = _mm256_set1_epi32(target.m_origin.y);
+    const auto  w            = _mm256_set1_epi32(target.m_width);
+    const auto  h            = _mm256_set1_epi32(target.m_height);
+    const auto  minus_one    = _mm256_set1_epi32(-1);
+    const auto  step         = _mm256_set1_epi32(static_cast<int32_t>(target.m_step));
+    const auto  three        = _mm256_set1_epi32(3);
+    alignas(32) std::array<int32_t, 8> offsets{};
+    size_t i = 0;
+    for (; i + 8 <= points.size(); i += 8) {
+        // x0 y0 x1 y1 ... -> x0 x1 x2 x3 y0 y1 y2 y3
+        auto a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2)), deinterleave);       // NOLINT
+        auto b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2 + 8)), deinterleave);   // NOLINT
+        auto x = _mm256_sub_epi32(_mm256_permute2x128_si256(a, b, 0x20), ox);
+        auto y = _mm256_sub_epi32(_mm256_permute2x128_si256(a, b, 0x31), oy);
+        // 0 <= x < w && 0 <= y < h
+        auto inside = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(x, minus_one), _mm256_cmpgt_epi32(w, x)), _mm256_and_si256(_mm256_cmpgt_epi32(y, minus_one), _mm256_cmpgt_epi32(h, y)));
+        auto mask   = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(inside)));
+        if (mask == 0) {
+            continue;
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(offsets.data()), _mm256_add_epi32(_mm256_mullo_epi32(y, step), _mm256_mullo_epi32(x, three)));   // NOLINT
+        drawn += static_cast<size_t>(std::popcount(mask));
+        putMasked(target, color, i, mask, offsets.data());
+    }
+    return i;
+}
+#endif
+
+// color(i) 返回第 i 个点的颜色
+template <typename ColorOf>
+auto scatter(cv::Mat& image, const PointInt2& origin, std::span<const PointInt2> points, ColorOf color) -> size_t {
+    if (image.type() != CV_8UC3) {
+        throw tg_exception("scatterPoints needs a CV_8UC3 image, type {}", image.type());
+    }
+    Target target{
+        .m_data   = image.data,
+        .m_step   = image.step[0],
+        .m_width  = image.cols,
+        .m_height = image.rows,
+        .m_origin = origin,
+    };
+
+    size_t drawn = 0;
+    size_t i     = 0;
+#if defined(TG_X86)
+    // 32 位偏移量能表示整个图像时才使用
+    if (target.m_step * static_cast<size_t>(target.m_height) <= static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        if (cpu::hasAvx512()) {
+            i = scatterAvx512(target, points, color, drawn);
+        }
+        else if (cpu::hasAvx2()) {
+            i = scatterAvx2(target, points, color, drawn);
+        }
+    }
+#endif
+    for (; i < points.size(); i++) {
+        auto x = static_cast<int64_t>(points[i].x) - origin.x;
+        auto y = static_cast<int64_t>(points[i].y) - origin.y;
+        if (x >= 0 && y >= 0 && x < target.m_width && y < target.m_height) {
+            target.put(color, i, static_cast<size_t>(y) * target.m_step + static_cast<size_t>(x) * 3);
+            drawn++;
+        }
+    }
+    return drawn;
+}
+}   // namespace
+
+auto scatterPoints(cv::Mat& image, const PointInt2& origin, std::span<const PointInt2> points, const Color32& color) -> size_t {
+    return scatter(image, origin, points, [color](size_t) { return color; });
+}
+
+auto scatterPoints(cv::Mat& image, const PointInt2& origin, std::span<const PointInt2> points, std::span<const Color32> colors) -> size_t {
+    if (colors.size() != points.size()) {
+        throw tg_exception("scatterPoints: {} points, {} colors", points.size(), colors.size());
+    }
+    return scatter(image, origin, points, [colors](size_t i) { return colors[i]; });
+}
+}   // namespace tg::render
@@ -0,0 +1,18 @@
+#pragma once
+#include <tg/Color.h>
+#include <tg/Point.h>
+
+#include <opencv2/opencv.hpp>
+#include <span>
+
+namespace tg::render {
+// 批量绘制单像素的点 (散点图等) 到 CV_8UC3 图像. origin 为 image 左上角在点坐标系中的位置 (画布的 ROI 视图使用画布坐标).
+// 图像外的点忽略, 按顺序写入, 重叠时后面的点覆盖前面的点, 与逐点绘制的结果相同.
+// 坐标的裁剪和像素地址的计算按处理器支持的指令集每次处理 16 个 (AVX-512) 或 8 个 (AVX2) 点,
+// 写入逐点进行 (像素为 3 字节, 不能用 32 位的 scatter 写入).
+// 返回画在图像内的点数
+auto scatterPoints(cv::Mat& image, const PointInt2& origin, std::span<const PointInt2> points, const Color32& color) -> size_t;
+
+// colors 与 points 一一对应
+auto scatterPoints(cv::Mat& image, const PointInt2& origin, std::span<const PointInt2> points, std::span<const Color32> colors) -> size_t;
+}   // namespace tg::render
@@ -0,0 +1,227 @@
+#include <tg/parallel.h>
+#include <tg/render/SpriteBatch.h>
+
+namespace tg::render {
+namespace {
+constexpr size_t k_channels = 4;
+
+// 满足 0 <= u0 + du * x < limit 的 x 的范围与 [begin, end) 的交, 端点可能因为舍入多出一个像素, 由调用者逐像素修正
+auto coverage(float u0, float du, float limit, int begin, int end) -> std::pair<int, int> {
+    if (du == 0) {
+        return u0 >= 0 && u0 < limit ? std::pair{begin, end} : std::pair{begin, begin};
+    }
+    auto a  = -u0 / du;
+    auto b  = (limit - u0) / du;
+    auto lo = std::min(a, b);
+    auto hi = std::max(a, b);
+    // 限制在 int 范围内再取整
+    auto first = static_cast<int>(std::ceil(std::clamp(lo, static_cast<float>(begin) - 1, static_cast<float>(end) + 1))) - 1;
+    auto last  = static_cast<int>(std::ceil(std::clamp(hi, static_cast<float>(begin) - 1, static_cast<float>(end) + 1))) + 1;
+    return {std::max(first, begin), std::min(last, end)};
+}
+}   // namespace
+
+auto SpriteBatch::addSprite(const cv::Mat& image) -> SpriteId {
+    if (image.type() != CV_8UC3 && image.type() != CV_8UC4) {
+        throw tg_exception("sprite needs a CV_8UC3 or CV_8UC4 image, type {}", image.type());
+    }
+    if (image.rows == 0 || image.cols == 0) {
+        throw tg_exception("empty sprite");
+    }
+    Sprite sprite{image.cols, image.rows, {}};
+    sprite.m_pixels.resize(static_cast<size_t>(image.cols) * static_cast<size_t>(image.rows) * k_channels);
+    auto  channels = static_cast<size_t>(image.channels());
+    auto* out      = sprite.m_pixels.data();
+    for (int y = 0; y < image.rows; y++) {
+        const auto* in = image.ptr<uint8_t>(y);
+        for (int x = 0; x < image.cols; x++, in += channels, out += k_channels) {
+            auto a = channels == 4 ? static_cast<float>(in[3]) / 255.F : 1.F;
+            out[0] = static_cast<float>(in[0]) * a;
+            out[1] = static_cast<float>(in[1]) * a;
+            out[2] = static_cast<float>(in[2]) * a;
+            out[3] = a;
+        }
+    }
+    m_sprites.push_back(std::move(sprite));
+    return static_cast<SpriteId>(m_sprites.size() - 1);
+}
+
+auto SpriteBatch::draw(SpriteId sprite, const Affine2& transform, const Color& tint, float alpha) -> void {
+    if (sprite >= m_sprites.size()) {
+        throw tg_exception("invalid sprite: {}", sprite);
+    }
+    // 不可见或退化为线段的实例直接丢弃
+    if (!(alpha > 0) || !(std::abs(transform.determinant()) > 1e-12F)) {
+        return;
+    }
+    m_instances.push_back({
+        .m_sprite    = sprite,
+        .m_transform = transform,
+        .m_inverse   = transform.inverted(),
+        .m_color     = {tint.b * alpha, tint.g * alpha, tint.r * alpha, alpha},
+    });
+}
+
+auto SpriteBatch::render(cv::Mat& image, SpriteSampling sampling) -> void {
+    if (image.type() != CV_8UC3) {
+        throw tg_exception("SpriteBatch needs a CV_8UC3 image");
+    }
+    if (m_instances.empty() || image.rows == 0 || image.cols == 0) {
+        m_instances.clear();
+        return;
+    }
+
+    // 变换后的包围盒与画布的交
+    for (auto& i : m_instances) {
+        const auto& sprite = m_sprites[i.m_sprite];
+        auto        w      = static_cast<float>(sprite.m_width);
+        auto        h      = static_cast<float>(sprite.m_height);
+        auto        min    = Point2(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+        auto        max    = Point2(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+        for (const auto& corner : {Point2(0, 0), Point2(w, 0), Point2(0, h), Point2(w, h)}) {
+            auto p = i.m_transform.apply(corner);
+            min    = Point2(std::min(min.x, p.x), std::min(min.y, p.y));
+            max    = Point2(std::max(max.x, p.x), std::max(max.y, p.y));
+        }
+        auto clampX = [&](float v) { return static_cast<int>(std::clamp(v, 0.F, static_cast<float>(image.cols))); };
+        auto clampY = [&](float v) { return static_cast<int>(std::clamp(v, 0.F, static_cast<float>(image.rows))); };
+        i.m_x0      = clampX(std::floor(min.x));
+        i.m_y0      = clampY(std::floor(min.y));
+        i.m_x1      = clampX(std::ceil(max.x));
+        i.m_y1      = clampY(std::ceil(max.y));
+    }
+
+    // 实例按提交顺序分到覆盖的块中
+    auto tiles_x = (image.cols + k_tile_size - 1) / k_tile_size;
+    auto tiles_y = (image.rows + k_tile_size - 1) / k_tile_size;
+    auto tiles   = static_cast<size_t>(tiles_x) * static_cast<size_t>(tiles_y);
+    auto visit   = [&](const Instance& i, auto&& f) {
+        if (i.m_x0 >= i.m_x1 || i.m_y0 >= i.m_y1) {
+            return;
+        }
+        for (auto ty = i.m_y0 / k_tile_size; ty <= (i.m_y1 - 1) / k_tile_size; ty++) {
+            for (auto tx = i.m_x0 / k_tile_size; tx <= (i.m_x1 - 1) / k_tile_size; tx++) {
+                f(static_cast<size_t>(ty) * static_cast<size_t>(tiles_x) + static_cast<size_t>(tx));
+            }
+        }
+    };
+    m_tile_offsets.assign(tiles + 1, 0);
+    for (const auto& i : m_instances) {
+        visit(i, [&](size_t t) { m_tile_offsets[t + 1]++; });
+    }
+    for (size_t t = 0; t < tiles; t++) {
+        m_tile_offsets[t + 1] += m_tile_offsets[t];
+    }
+    m_tile_instances.resize(m_tile_offsets.back());
+    std::vector<size_t> cursor(m_tile_offsets.begin(), m_tile_offsets.end() - 1);
+    for (uint32_t k = 0; k < m_instances.size(); k++) {
+        visit(m_instances[k], [&](size_t t) { m_tile_instances[cursor[t]++] = k; });
+    }
+
+    parallelFor(0, tiles, 1, [&](size_t b, size_t e) {
+        for (auto t = b; t < e; t++) {
+            auto tx = static_cast<int>(t % static_cast<size_t>(tiles_x)) * k_tile_size;
+            auto ty = static_cast<int>(t / static_cast<size_t>(tiles_x)) * k_tile_size;
+            if (sampling == SpriteSampling::Bilinear) {
+                renderTile<SpriteSampling::Bilinear>(image, tx, ty, t);
+            }
+            else {
+                renderTile<SpriteSampling::Nearest>(image, tx, ty, t);
+            }
+        }
+    });
+    m_instances.clear();
+}
+
+template <SpriteSampling Sampling>
+auto SpriteBatch::renderTile(cv::Mat& image, int tile_x, int tile_y, size_t tile) const -> void {
+    auto tile_x1 = std::min(tile_x + k_tile_size, image.cols);
+    auto tile_y1 = std::min(tile_y + k_tile_size, image.rows);
+    for (auto k = m_tile_offsets[tile]; k < m_tile_offsets[tile + 1]; k++) {
+        const auto& inst   = m_instances[m_tile_instances[k]];
+        const auto& sprite = m_sprites[inst.m_sprite];
+        const auto& inv    = inst.m_inverse;
+        const auto* pixels = sprite.m_pixels.data();
+        auto        stride = static_cast<size_t>(sprite.m_width) * k_channels;
+        auto        last_u = sprite.m_width - 1;   // 写入 uint8_t 可能与任何内存重叠, 循环中用到的量都先复制到局部变量
+        auto        last_v = sprite.m_height - 1;
+        auto        w      = static_cast<float>(sprite.m_width);
+        auto        h      = static_cast<float>(sprite.m_height);
+        auto        color  = inst.m_color;
+        auto        x0     = std::max(inst.m_x0, tile_x);
+        auto        x1     = std::min(inst.m_x1, tile_x1);
+        auto        y0     = std::max(inst.m_y0, tile_y);
+        auto        y1     = std::min(inst.m_y1, tile_y1);
+
+        for (auto y = y0; y < y1; y++) {
+            // 像素中心 (x + 0.5, y + 0.5) 对应的图像坐标 u = u0 + du * x, v = v0 + dv * x
+            auto cy = static_cast<float>(y) + 0.5F;
+            auto u0 = inv.m_a * 0.5F + inv.m_b * cy + inv.m_tx;
+            auto v0 = inv.m_c * 0.5F + inv.m_d * cy + inv.m_ty;
+            auto du = inv.m_a;
+            auto dv = inv.m_c;
+
+            auto inside = [&](int x) {
+                auto u = u0 + du * static_cast<float>(x);
+                auto v = v0 + dv * static_cast<float>(x);
+                return u >= 0 && u < w && v >= 0 && v < h;
+            };
+            auto [ua, ub] = coverage(u0, du, w, x0, x1);
+            auto [va, vb] = coverage(v0, dv, h, x0, x1);
+            auto begin    = std::max(ua, va);
+            auto end      = std::min(ub, vb);
+            while (begin < end && !inside(begin)) {
+                begin++;
+            }
+            while (end > begin && !inside(end - 1)) {
+                end--;
+            }
+
+            auto* dst = image.ptr<uint8_t>(y) + static_cast<ptrdiff_t>(begin) * 3;
+            for (auto x = begin; x < end; x++, dst += 3) {
+                auto                 u = u0 + du * static_cast<float>(x);
+                auto                 v = v0 + dv * static_cast<float>(x);
+                std::array<float, 4> s{};
+                if constexpr (Sampling == SpriteSampling::Nearest) {
+                    auto        iu = std::min(static_cast<int>(u), last_u);
+                    auto        iv = std::min(static_cast<int>(v), last_v);
+                    const auto* p  = pixels + static_cast<size_t>(iv) * stride + static_cast<size_t>(iu) * k_channels;
+                    for (size_t c = 0; c < k_channels; c++) {
+                        s[c] = p[c];
+                    }
+                }
+                else {
+                    // 在相邻的像素中心之间插值, 图像边缘按复制边缘像素处理. u, v 在图像内, 加 0.5 后截断即为向下取整
+                    auto fu = u + 0.5F;
+                    auto fv = v + 0.5F;
+                    auto bu = static_cast<int>(fu) - 1;   // floor(u - 0.5), 范围 -1 ~ 宽 - 1
+                    auto bv = static_cast<int>(fv) - 1;
+                    auto tu = fu - static_cast<float>(bu + 1);
+                    auto tv = fv - static_cast<float>(bv + 1);
+
+                    const auto* row0 = pixels + static_cast<size_t>(std::max(bv, 0)) * stride;
+                    const auto* row1 = pixels + static_cast<size_t>(std::min(bv + 1, last_v)) * stride;
+                    auto        iu0  = static_cast<size_t>(std::max(bu, 0)) * k_channels;
+                    auto        iu1  = static_cast<size_t>(std::min(bu + 1, last_u)) * k_channels;
+                    const auto* p00  = row0 + iu0;
+                    const auto* p01  = row0 + iu1;
+                    const auto* p10  = row1 + iu0;
+                    const auto* p11  = row1 + iu1;
+                    for (size_t c = 0; c < k_channels; c++) {
+                        auto top    = p00[c] + tu * (p01[c] - p00[c]);
+                        auto bottom = p10[c] + tu * (p11[c] - p10[c]);
+                        s[c]        = top + tv * (bottom - top);
+                    }
+                }
+                for (size_t c = 0; c < k_channels; c++) {
+                    s[c] *= color[c];
+                }
+                auto keep = 1 - s[3];
+                for (size_t c = 0; c < 3; c++) {
+                    dst[c] = static_cast<uint8_t>(std::clamp(static_cast<float>(dst[c]) * keep + s[c] + 0.5F, 0.F, 255.F));
+                }
+            }
+        }
+    }
+}
+}   // namespace tg::render
@@ -0,0 +1,140 @@
+#pragma once
+#include <tg/Color.h>
+#include <tg/Point.h>
+
+#include <opencv2/opencv.hpp>
+
+namespace tg::render {
+// 二维仿射变换: (x, y) -> (m_a * x + m_b * y + m_tx, m_c * x + m_d * y + m_ty)
+class Affine2 {
+public:
+    float m_a  = 1;
+    float m_b  = 0;
+    float m_tx = 0;
+    float m_c  = 0;
+    float m_d  = 1;
+    float m_ty = 0;
+
+    static auto translate(const Point2& offset) -> Affine2 {
+        return {.m_tx = offset.x, .m_ty = offset.y};
+    }
+
+    static auto scale(float sx, float sy) -> Affine2 {
+        return {.m_a = sx, .m_d = sy};
+    }
+
+    static auto rotate(float radians) -> Affine2 {
+        auto c = std::cos(radians);
+        auto s = std::sin(radians);
+        return {.m_a = c, .m_b = -s, .m_c = s, .m_d = c};
+    }
+
+    // 先执行 right 再执行 left
+    friend auto operator*(const Affine2& left, const Affine2& right) -> Affine2 {
+        return {
+            .m_a  = left.m_a * right.m_a + left.m_b * right.m_c,
+            .m_b  = left.m_a * right.m_b + left.m_b * right.m_d,
+            .m_tx = left.m_a * right.m_tx + left.m_b * right.m_ty + left.m_tx,
+            .m_c  = left.m_c * right.m_a + left.m_d * right.m_c,
+            .m_d  = left.m_c * right.m_b + left.m_d * right.m_d,
+            .m_ty = left.m_c * right.m_tx + left.m_d * right.m_ty + left.m_ty,
+        };
+    }
+
+    auto apply(const Point2& p) const -> Point2 {
+        return {m_a * p.x + m_b * p.y + m_tx, m_c * p.x + m_d * p.y + m_ty};
+    }
+
+    auto determinant() const {
+        return m_a * m_d - m_b * m_c;
+    }
+
+    // 行列式为 0 时结果无意义
+    auto inverted() const -> Affine2 {
+        auto inv = 1 / determinant();
+        auto a   = m_d * inv;
+        auto b   = -m_b * inv;
+        auto c   = -m_c * inv;
+        auto d   = m_a * inv;
+        return {.m_a = a, .m_b = b, .m_tx = -(a * m_tx + b * m_ty), .m_c = c, .m_d = d, .m_ty = -(c * m_tx + d * m_ty)};
+    }
+};
+
+enum class SpriteSampling : uint8_t {
+    Nearest,
+    Bilinear,
+};
+
+// 批量绘制带仿射变换的小图 (图标, 标记等).
+// 图像注册一次后转换为预乘 alpha 的 float BGRA 常驻; 每帧提交任意多个实例 (图像, 变换, 着色, 透明度),
+// render 时把画布分为 k_tile_size 的块, 实例按包围盒分到块中, 各块在线程池中并行按提交顺序混合.
+// 每行的覆盖范围由逆变换直接求出, 只对像素中心落在图像内的像素采样, 不会越界也不会漏画边缘.
+//
+//  render::SpriteBatch batch;
+//  auto icon = batch.addSprite(cv::imread("icon.png", cv::IMREAD_UNCHANGED));
+//  batch.draw(icon, render::Affine2::translate(p) * render::Affine2::rotate(angle));
+//  batch.render(image);
+class SpriteBatch {
+public:
+    using SpriteId = uint32_t;
+
+    static constexpr int k_tile_size = 64;
+
+    // CV_8UC3 (BGR) 或 CV_8UC4 (BGRA)
+    auto addSprite(const cv::Mat& image) -> SpriteId;
+
+    auto spriteSize(SpriteId sprite) const -> PointInt2 {
+        const auto& s = m_sprites.at(sprite);
+        return {s.m_width, s.m_height};
+    }
+
+    auto spriteCount() const {
+        return m_sprites.size();
+    }
+
+    // transform 把图像坐标 (像素 (i, j) 占据 [i, i + 1) x [j, j + 1)) 变换到画布坐标; 颜色乘以 tint
+    auto draw(SpriteId sprite, const Affine2& transform, const Color& tint = constants::white, float alpha = 1) -> void;
+
+    // 混合到 CV_8UC3 图像, 之后清空实例
+    auto render(cv::Mat& image, SpriteSampling sampling = SpriteSampling::Bilinear) -> void;
+
+    auto clear() -> void {
+        m_instances.clear();
+    }
+
+    auto empty() const {
+        return m_instances.empty();
+    }
+
+    // 待绘制的实例数
+    auto size() const {
+        return m_instances.size();
+    }
+
+private:
+    struct Sprite {
+        int                m_width;
+        int                m_height;
+        std::vector<float> m_pixels;   // 预乘 alpha 的 BGRA, 颜色 0 ~ 255, alpha 0 ~ 1
+    };
+
+    struct Instance {
+        SpriteId             m_sprite;
+        Affine2              m_transform;
+        Affine2              m_inverse;
+        std::array<float, 4> m_color;     // 与采样结果逐分量相乘: tint * alpha, alpha
+        int                  m_x0 = 0;    // 包围盒与画布的交, render 时计算
+        int                  m_y0 = 0;
+        int                  m_x1 = 0;
+        int                  m_y1 = 0;
+    };
+
+    template <SpriteSampling Sampling>
+    auto renderTile(cv::Mat& image, int tile_x, int tile_y, size_t tile) const -> void;
+
+    std::vector<Sprite>   m_sprites;
+    std::vector<Instance> m_instances;
+    std::vector<size_t>   m_tile_offsets;
+    std::vector<uint32_t> m_tile_instances;
+};
+}   // namespace tg::render
@@ -0,0 +1,254 @@
+#include <tg/shm/FrameRing.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tg::shm {
+namespace {
+constexpr auto k_alignment = 64ULL;
+
+constexpr auto alignUp(uint64_t v) {
+    return (v + k_alignment - 1) / k_alignment * k_alignment;
+}
+
+#ifndef _WIN32
+// POSIX 共享内存的名字必须以 / 开头
+auto posixName(std::string_view name) {
+    return std::format("/{}", name);
+}
+#endif
+}   // namespace
+
+SharedMemory::~SharedMemory() {
+    reset();
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)), m_name(std::move(other.m_name)), m_owner(std::exchange(other.m_owner, false)) {
+#ifdef _WIN32
+    m_handle = std::exchange(other.m_handle, nullptr);
+#endif
+}
+
+auto SharedMemory::operator=(SharedMemory&& other) noexcept -> SharedMemory& {
+    if (this != &other) {
+        reset();
+        m_data  = std::exchange(other.m_data, nullptr);
+        m_size  = std::exchange(other.m_size, 0);
+        m_name  = std::move(other.m_name);
+        m_owner = std::exchange(other.m_owner, false);
+#ifdef _WIN32
+        m_handle = std::exchange(other.m_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+auto SharedMemory::reset() -> void {
+#ifdef _WIN32
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_handle) {
+        CloseHandle(m_handle);
+    }
+    m_handle = nullptr;
+#else
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+    if (m_owner) {
+        shm_unlink(posixName(m_name).c_str());
+    }
+#endif
+    m_data  = nullptr;
+    m_size  = 0;
+    m_owner = false;
+}
+
+auto SharedMemory::create(std::string_view name, size_t size) -> SharedMemory {
+    SharedMemory memory;
+    memory.m_name = name;
+#ifdef _WIN32
+    memory.m_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32U), static_cast<DWORD>(size), memory.m_name.c_str());
+    if (!memory.m_handle) {
+        throw tg_exception("CreateFileMapping error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    // 同名的映射已经存在时返回已有的映射 (大小不变), 可能属于另一个程序
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        throw tg_exception("shared memory exists: {}", name);
+    }
+    memory.m_data = static_cast<std::byte*>(MapViewOfFile(memory.m_handle, FILE_MAP_ALL_ACCESS, 0, 0, size));
+#else
+    // 不删除已有的同名共享内存, 它可能属于另一个正在运行的程序
+    auto fd = shm_open(posixName(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        throw tg_exception("shared memory exists: {} (used by another process, or left by one that crashed: remove /dev/shm/{})", name, name);
+    }
+    if (fd < 0) {
+        throw tg_exception("shm_open error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    memory.m_owner = true;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        throw tg_exception("ftruncate error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    auto* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    memory.m_data = data == MAP_FAILED ? nullptr : static_cast<std::byte*>(data);
+#endif
+    if (!memory.m_data) {
+        throw tg_exception("map shared memory error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    memory.m_size = size;
+    return memory;
+}
+
+auto SharedMemory::open(std::string_view name) -> SharedMemory {
+    SharedMemory memory;
+    memory.m_name = name;
+#ifdef _WIN32
+    memory.m_handle = OpenFileMappingA(FILE_MAP_READ, FALSE, memory.m_name.c_str());
+    if (!memory.m_handle) {
+        throw tg_exception("OpenFileMapping error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    memory.m_data = static_cast<std::byte*>(MapViewOfFile(memory.m_handle, FILE_MAP_READ, 0, 0, 0));
+    if (memory.m_data) {
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(memory.m_data, &info, sizeof(info));
+        memory.m_size = info.RegionSize;
+    }
+#else
+    auto fd = shm_open(posixName(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw tg_exception("shm_open error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw tg_exception("fstat error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    memory.m_size = static_cast<size_t>(st.st_size);
+    auto* data    = mmap(nullptr, memory.m_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    memory.m_data = data == MAP_FAILED ? nullptr : static_cast<std::byte*>(data);
+#endif
+    if (!memory.m_data) {
+        throw tg_exception("map shared memory error: {}, {}", name, getSystemLastErrorAsString());
+    }
+    if (memory.m_size < sizeof(FrameRingHeader)) {
+        throw tg_exception("shared memory too small: {}", name);
+    }
+    return memory;
+}
+
+FrameRingWriter::FrameRingWriter(std::string_view name, uint64_t slot_capacity, uint32_t slot_count)
+    : m_name(name) {
+    if (slot_count < 2) {
+        throw tg_exception("FrameRingWriter slot count must be at least 2: {}", slot_count);
+    }
+    auto slot_stride = alignUp(sizeof(FrameSlot) + slot_capacity);
+    m_memory         = SharedMemory::create(name, sizeof(FrameRingHeader) + slot_stride * slot_count);
+
+    // 新映射的共享内存全部为 0, 原子变量的初始值即为 0
+    auto& h           = header();
+    h.m_magic         = FrameRingHeader::k_magic;
+    h.m_version       = FrameRingHeader::k_version;
+    h.m_slot_count    = slot_count;
+    h.m_slot_capacity = slot_capacity;
+    h.m_slot_stride   = slot_stride;
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+auto FrameRingWriter::publish(const void* data, uint32_t width, uint32_t height, size_t row_bytes, size_t src_stride, FrameFormat format) -> uint64_t {
+    auto& h    = header();
+    auto  size = row_bytes * height;
+    if (size > h.m_slot_capacity) {
+        throw tg_exception("FrameRingWriter frame too large: {}, {} > {}", m_name, size, h.m_slot_capacity);
+    }
+
+    auto  frame = ++m_frame;
+    auto* slot  = reinterpret_cast<FrameSlot*>(m_memory.data() + sizeof(FrameRingHeader) + (frame % h.m_slot_count) * h.m_slot_stride);
+    auto* dst   = reinterpret_cast<std::byte*>(slot) + sizeof(FrameSlot);
+
+    auto seq = slot->m_seq.load(std::memory_order_relaxed);
+    slot->m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->m_frame.store(frame, std::memory_order_relaxed);
+    slot->m_timestamp_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    slot->m_size.store(size, std::memory_order_relaxed);
+    slot->m_width.store(width, std::memory_order_relaxed);
+    slot->m_height.store(height, std::memory_order_relaxed);
+    slot->m_stride.store(static_cast<uint32_t>(row_bytes), std::memory_order_relaxed);
+    slot->m_format.store(static_cast<uint32_t>(format), std::memory_order_relaxed);
+    if (row_bytes == src_stride) {
+        std::memcpy(dst, data, size);
+    }
+    else {
+        for (uint32_t y = 0; y < height; y++) {
+            std::memcpy(dst + y * row_bytes, static_cast<const std::byte*>(data) + y * src_stride, row_bytes);
+        }
+    }
+
+    slot->m_seq.store(seq + 2, std::memory_order_release);
+    h.m_latest.store(frame, std::memory_order_release);
+    return frame;
+}
+
+FrameRingReader::FrameRingReader(std::string_view name)
+    : m_memory(SharedMemory::open(name)) {
+    auto& h = header();
+    if (h.m_magic != FrameRingHeader::k_magic || h.m_version != FrameRingHeader::k_version) {
+        throw tg_exception("invalid frame ring: {}", name);
+    }
+    if (sizeof(FrameRingHeader) + h.m_slot_stride * h.m_slot_count > m_memory.size()) {
+        throw tg_exception("frame ring truncated: {}", name);
+    }
+}
+
+auto FrameRingReader::acquireLatest() -> std::optional<FrameView> {
+    auto frame = latest();
+    if (frame == 0 || frame == m_last) {
+        return std::nullopt;
+    }
+    auto view = acquire(frame);
+    if (view) {
+        m_last = frame;
+    }
+    return view;
+}
+
+auto FrameRingReader::acquire(uint64_t frame) const -> std::optional<FrameView> {
+    auto& s   = slot(frame);
+    auto  seq = s.m_seq.load(std::memory_order_acquire);
+    if ((seq & 1U) != 0 || s.m_frame.load(std::memory_order_relaxed) != frame) {
+        return std::nullopt;
+    }
+
+    FrameView view;
+    view.m_frame        = frame;
+    view.m_timestamp_ns = s.m_timestamp_ns.load(std::memory_order_relaxed);
+    view.m_width        = s.m_width.load(std::memory_order_relaxed);
+    view.m_height       = s.m_height.load(std::memory_order_relaxed);
+    view.m_stride       = s.m_stride.load(std::memory_order_relaxed);
+    view.m_format       = static_cast<FrameFormat>(s.m_format.load(std::memory_order_relaxed));
+    view.m_data         = {slotData(s), std::min(s.m_size.load(std::memory_order_relaxed), header().m_slot_capacity)};
+    view.m_slot         = &s;
+    view.m_seq          = seq;
+    // 读取元数据期间槽位可能已经开始被覆盖
+    if (!view.valid()) {
+        return std::nullopt;
+    }
+    return view;
+}
+}   // namespace tg::shm
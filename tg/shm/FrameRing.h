@@ -0,0 +1,177 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <array>
+#include <atomic>
+#include <optional>
+#include <span>
+
+namespace tg::shm {
+// 共享内存中的帧环形缓冲区, 用于把画布内容零拷贝地提供给其它进程.
+//
+// 内存布局: FrameRingHeader | FrameSlot 0 | 数据 0 | FrameSlot 1 | 数据 1 | ...
+// 每个槽位使用 seqlock: 写入前 seq 加一变为奇数, 写完后再加一变为偶数.
+// 读者直接读取共享内存中的数据, 读完后检查 seq 没有变化即说明数据没有被覆盖,
+// 整个过程没有锁, 也没有系统调用.
+enum class FrameFormat : uint32_t {
+    BGR8  = 1,   // cv::Mat CV_8UC3
+    BGRA8 = 2,   // cv::Mat CV_8UC4
+    Gray8 = 3,   // cv::Mat CV_8UC1
+};
+
+class alignas(64) FrameRingHeader {
+public:
+    static constexpr std::array<char, 8> k_magic   = {'T', 'G', 'F', 'R', 'A', 'M', 'E', '\0'};
+    static constexpr uint32_t            k_version = 1;
+
+    std::array<char, 8>   m_magic;
+    uint32_t              m_version;
+    uint32_t              m_slot_count;
+    uint64_t              m_slot_capacity;   // 每个槽位最多能存放的字节数
+    uint64_t              m_slot_stride;     // 相邻槽位之间的字节数 (含 FrameSlot)
+    std::atomic<uint64_t> m_latest;          // 最新写完的帧序号, 0 表示还没有帧
+};
+
+class alignas(64) FrameSlot {
+public:
+    std::atomic<uint64_t> m_seq;            // seqlock, 奇数表示正在写入
+    std::atomic<uint64_t> m_frame;          // 帧序号, 槽位下标为 m_frame % m_slot_count
+    std::atomic<int64_t>  m_timestamp_ns;   // steady_clock, 可用于计算延迟
+    std::atomic<uint64_t> m_size;
+    std::atomic<uint32_t> m_width;
+    std::atomic<uint32_t> m_height;
+    std::atomic<uint32_t> m_stride;
+    std::atomic<uint32_t> m_format;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free, "进程间共享的原子变量必须是无锁的");
+
+// 一段命名共享内存 (POSIX shm_open / Win32 CreateFileMapping)
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory(SharedMemory&& other) noexcept;
+    auto operator=(const SharedMemory&) = delete;
+    auto operator=(SharedMemory&& other) noexcept -> SharedMemory&;
+
+    // 创建者负责删除共享内存的名字, 已经打开的读者不受影响. 名字已经存在时抛出异常
+    static auto create(std::string_view name, size_t size) -> SharedMemory;
+    static auto open(std::string_view name) -> SharedMemory;
+
+    auto data() const {
+        return m_data;
+    }
+
+    auto size() const {
+        return m_size;
+    }
+
+private:
+    auto reset() -> void;
+
+    std::byte*  m_data  = nullptr;
+    size_t      m_size  = 0;
+    std::string m_name;
+    bool        m_owner = false;
+#ifdef _WIN32
+    void* m_handle = nullptr;
+#endif
+};
+
+// 写入端, 只能有一个写者
+class FrameRingWriter {
+public:
+    static constexpr uint32_t k_default_slot_count = 3;
+
+    FrameRingWriter(std::string_view name, uint64_t slot_capacity, uint32_t slot_count = k_default_slot_count);
+
+    auto name() const -> const std::string& {
+        return m_name;
+    }
+
+    auto slotCapacity() const {
+        return header().m_slot_capacity;
+    }
+
+    // 共享内存的大小, 包括文件头和所有槽位
+    auto memoryBytes() const {
+        return m_memory.size();
+    }
+
+    // 写入一帧 (每行 row_bytes 字节, 源数据行间距为 src_stride), 返回帧序号
+    auto publish(const void* data, uint32_t width, uint32_t height, size_t row_bytes, size_t src_stride, FrameFormat format) -> uint64_t;
+
+private:
+    auto header() const -> FrameRingHeader& {
+        return *reinterpret_cast<FrameRingHeader*>(m_memory.data());
+    }
+
+    std::string  m_name;
+    SharedMemory m_memory;
+    uint64_t     m_frame = 0;
+};
+
+// 读取端, 可以有任意多个读者 (可以在不同进程中)
+class FrameRingReader {
+public:
+    // 共享内存中一帧的视图, 数据没有拷贝, 使用完之后调用 valid() 确认读取期间没有被覆盖
+    class FrameView {
+    public:
+        uint64_t                   m_frame;
+        int64_t                    m_timestamp_ns;
+        uint32_t                   m_width;
+        uint32_t                   m_height;
+        uint32_t                   m_stride;
+        FrameFormat                m_format;
+        std::span<const std::byte> m_data;
+
+        auto valid() const -> bool {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_slot->m_seq.load(std::memory_order_relaxed) == m_seq;
+        }
+
+    private:
+        friend class FrameRingReader;
+
+        const FrameSlot* m_slot;
+        uint64_t         m_seq;
+    };
+
+    explicit FrameRingReader(std::string_view name);
+
+    auto slotCount() const {
+        return header().m_slot_count;
+    }
+
+    // 最新写完的帧序号, 0 表示还没有帧
+    auto latest() const {
+        return header().m_latest.load(std::memory_order_acquire);
+    }
+
+    // 获取最新的一帧, 没有新帧或者正在被覆盖时返回空
+    auto acquireLatest() -> std::optional<FrameView>;
+
+    // 获取指定序号的帧, 已经被覆盖或者正在写入时返回空
+    auto acquire(uint64_t frame) const -> std::optional<FrameView>;
+
+private:
+    auto header() const -> const FrameRingHeader& {
+        return *reinterpret_cast<const FrameRingHeader*>(m_memory.data());
+    }
+
+    auto slot(uint64_t frame) const -> const FrameSlot& {
+        auto& h = header();
+        return *reinterpret_cast<const FrameSlot*>(m_memory.data() + sizeof(FrameRingHeader) + (frame % h.m_slot_count) * h.m_slot_stride);
+    }
+
+    auto slotData(const FrameSlot& s) const {
+        return reinterpret_cast<const std::byte*>(&s) + sizeof(FrameSlot);
+    }
+
+    SharedMemory m_memory;
+    uint64_t     m_last = 0;
+};
+}   // namespace tg::shm
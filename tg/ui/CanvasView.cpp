@@ -0,0 +1,168 @@
+#include <tg/parallel.h>
+#include <tg/render/PointScatter.h>
+#include <tg/ui/CanvasView.h>
+
+#include <mutex>
+#include <thread>
+
+namespace tg::ui {
+namespace {
+auto toBGR(const Color& color) {
+    return cv::Scalar(color.get_b8(), color.get_g8(), color.get_r8());
+}
+
+#ifndef NDEBUG
+// 正在绘制的视图, 同一画布上不同线程的视图相交时抛出异常
+class DrawScope {
+public:
+    DrawScope(const uint8_t* canvas, const cv::Rect& rect)
+        : m_canvas(canvas), m_rect(rect) {
+        std::lock_guard lock(s_mutex);
+        auto            thread = std::this_thread::get_id();
+        for (const auto& d : s_active) {
+            if (d.m_canvas == canvas && d.m_thread != thread && (d.m_rect & rect).area() > 0) {
+                throw tg_exception("CanvasView ({}, {}, {}, {}) overlaps a view being drawn on another thread ({}, {}, {}, {})", rect.x, rect.y, rect.width, rect.height, d.m_rect.x, d.m_rect.y, d.m_rect.width, d.m_rect.height);
+            }
+        }
+        s_active.push_back({canvas, rect, thread});
+    }
+
+    ~DrawScope() {
+        std::lock_guard lock(s_mutex);
+        auto            it = std::ranges::find_if(s_active, [&](const Active& d) { return d.m_canvas == m_canvas && d.m_rect == m_rect && d.m_thread == std::this_thread::get_id(); });
+        if (it != s_active.end()) {
+            s_active.erase(it);
+        }
+    }
+
+    DrawScope(const DrawScope&)      = delete;
+    DrawScope(DrawScope&&)           = delete;
+    auto operator=(const DrawScope&) = delete;
+    auto operator=(DrawScope&&)      = delete;
+
+private:
+    struct Active {
+        const uint8_t*  m_canvas;
+        cv::Rect        m_rect;
+        std::thread::id m_thread;
+    };
+
+    inline static std::mutex          s_mutex;
+    inline static std::vector<Active> s_active;
+
+    const uint8_t* m_canvas;
+    cv::Rect       m_rect;
+};
+#else
+class DrawScope {
+public:
+    DrawScope(const uint8_t* /*canvas*/, const cv::Rect& /*rect*/) {}
+};
+#endif
+}   // namespace
+
+CanvasView::CanvasView(cv::Mat& canvas, const cv::Rect& rect)
+    : m_canvas(canvas.data), m_rect(rect & cv::Rect(0, 0, canvas.cols, canvas.rows)) {
+    if (canvas.type() != CV_8UC3) {
+        throw tg_exception("CanvasView needs a CV_8UC3 image, type {}", canvas.type());
+    }
+    m_image = canvas(m_rect);
+}
+
+auto CanvasView::subview(const cv::Rect& rect) const -> CanvasView {
+    CanvasView v;
+    v.m_canvas = m_canvas;
+    v.m_rect   = rect & m_rect;
+    v.m_image  = m_image(v.m_rect - cv::Point(m_rect.x, m_rect.y));
+    return v;
+}
+
+auto CanvasView::splitRows(int count) const -> std::vector<CanvasView> {
+    std::vector<CanvasView> views;
+    count = std::clamp(count, 1, std::max(m_rect.height, 1));
+    views.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        auto y0 = m_rect.y + m_rect.height * i / count;
+        auto y1 = m_rect.y + m_rect.height * (i + 1) / count;
+        views.push_back(subview({m_rect.x, y0, m_rect.width, y1 - y0}));
+    }
+    return views;
+}
+
+auto CanvasView::splitTiles(int tile_width, int tile_height) const -> std::vector<CanvasView> {
+    if (tile_width <= 0 || tile_height <= 0) {
+        throw tg_exception("invalid tile size: {}x{}", tile_width, tile_height);
+    }
+    std::vector<CanvasView> views;
+    for (auto y = m_rect.y; y < m_rect.y + m_rect.height; y += tile_height) {
+        for (auto x = m_rect.x; x < m_rect.x + m_rect.width; x += tile_width) {
+            views.push_back(subview({x, y, tile_width, tile_height}));
+        }
+    }
+    return views;
+}
+
+auto CanvasView::overlapping(std::span<const CanvasView> views) -> bool {
+    for (size_t i = 0; i < views.size(); i++) {
+        for (auto j = i + 1; j < views.size(); j++) {
+            if (views[i].m_canvas == views[j].m_canvas && (views[i].m_rect & views[j].m_rect).area() > 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+auto CanvasView::parallelDraw(std::span<CanvasView> views, const std::function<void(CanvasView&)>& f) -> void {
+#ifndef NDEBUG
+    if (overlapping(views)) {
+        throw tg_exception("CanvasView::parallelDraw: views overlap");
+    }
+#endif
+    parallelFor(0, views.size(), 1, [&](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            f(views[i]);
+        }
+    });
+}
+
+auto CanvasView::drawBackground(const Color& color) -> void {
+    DrawScope scope(m_canvas, m_rect);
+    m_image.setTo(toBGR(color));
+}
+
+auto CanvasView::drawPoint(const PointInt2& p, const Color& color) -> void {
+    if (!pointInView(p)) {
+        return;
+    }
+    DrawScope scope(m_canvas, m_rect);
+    m_image.at<cv::Vec3b>(p.y - m_rect.y, p.x - m_rect.x) = cv::Vec3b(color.get_b8(), color.get_g8(), color.get_r8());
+}
+
+auto CanvasView::drawPoints(std::span<const PointInt2> points, std::span<const Color32> colors) -> void {
+    if (m_rect.empty()) {
+        return;
+    }
+    DrawScope scope(m_canvas, m_rect);
+    render::scatterPoints(m_image, origin(), points, colors);
+}
+
+auto CanvasView::drawPoints(std::span<const PointInt2> points, const Color32& color) -> void {
+    if (m_rect.empty()) {
+        return;
+    }
+    DrawScope scope(m_canvas, m_rect);
+    render::scatterPoints(m_image, origin(), points, color);
+}
+
+auto CanvasView::drawLine(const PointFixed2& begin, const PointFixed2& end, const Color& color, int thickness) -> void {
+    if (m_rect.empty()) {
+        return;
+    }
+    DrawScope scope(m_canvas, m_rect);
+    // 平移到视图坐标, 平移量是整数像素, 光栅化结果与在整个画布上绘制相同; opencv 把线段裁剪到 ROI 内
+    auto dx = m_rect.x * Fixed::k_one;
+    auto dy = m_rect.y * Fixed::k_one;
+    cv::line(m_image, {begin.x.raw() - dx, begin.y.raw() - dy}, {end.x.raw() - dx, end.y.raw() - dy}, toBGR(color), thickness, cv::LINE_AA, Fixed::k_frac_bits);
+}
+}   // namespace tg::ui
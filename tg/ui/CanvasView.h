@@ -0,0 +1,123 @@
+#pragma once
+#include <tg/Color.h>
+#include <tg/Point.h>
+#include <tg/Polyline.h>
+#include <tg/ui/PolylineClipper.h>
+
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include <span>
+
+namespace tg::ui {
+// 画布中一个矩形区域的视图: 与画布共享像素 (cv::Mat ROI, 行间距为画布的行间距), 不复制.
+// 绘制函数使用画布坐标, 结果裁剪到视图范围内, 不会写到视图以外, 所以不相交的视图可以在不同线程中同时绘制.
+// 一个图元跨越多个视图时, 在每个视图中各画一次即可.
+// 同一个视图只能在一个线程中使用. Debug 构建中检查不同线程同时绘制的视图是否相交, 相交时抛出异常
+//  auto views = canvas.view().splitTiles(128, 128);
+//  CanvasView::parallelDraw(views, [&](CanvasView& v) {
+//      for (auto& line : lines) {
+//          v.drawPolyline(line, constants::black);
+//      }
+//  });
+class CanvasView {
+public:
+    CanvasView() = default;
+
+    // rect 为画布坐标, 超出画布的部分被裁掉
+    CanvasView(cv::Mat& canvas, const cv::Rect& rect);
+
+    explicit CanvasView(cv::Mat& canvas)
+        : CanvasView(canvas, cv::Rect(0, 0, canvas.cols, canvas.rows)) {}
+
+    // 视图在画布中的范围
+    auto rect() const -> const cv::Rect& {
+        return m_rect;
+    }
+
+    auto origin() const -> PointInt2 {
+        return {m_rect.x, m_rect.y};
+    }
+
+    auto width() const {
+        return m_rect.width;
+    }
+
+    auto height() const {
+        return m_rect.height;
+    }
+
+    auto empty() const {
+        return m_rect.empty();
+    }
+
+    // 视图对应的像素, 坐标相对视图左上角
+    auto image() -> cv::Mat& {
+        return m_image;
+    }
+
+    // 与 rect (画布坐标) 的交
+    auto subview(const cv::Rect& rect) const -> CanvasView;
+
+    // 按行均分为 count 个不相交的视图
+    auto splitRows(int count) const -> std::vector<CanvasView>;
+
+    // 分为 tile_width x tile_height 的块, 最后一行和最后一列的块可能较小
+    auto splitTiles(int tile_width, int tile_height) const -> std::vector<CanvasView>;
+
+    // 在线程池中并行调用 f, 每个视图一个任务. Debug 构建中先检查视图是否两两不相交
+    static auto parallelDraw(std::span<CanvasView> views, const std::function<void(CanvasView&)>& f) -> void;
+
+    // 是否有属于同一画布且相交的两个视图
+    static auto overlapping(std::span<const CanvasView> views) -> bool;
+
+    auto pointInView(const PointInt2& p) const {
+        return p.x >= m_rect.x && p.y >= m_rect.y && p.x < m_rect.x + m_rect.width && p.y < m_rect.y + m_rect.height;
+    }
+
+    auto drawBackground(const Color& color = constants::white) -> void;
+
+    // 视图以外的点忽略
+    auto drawPoint(const PointInt2& p, const Color& color) -> void;
+
+    // 批量绘制点, 视图以外的点忽略
+    auto drawPoints(std::span<const PointInt2> points, std::span<const Color32> colors) -> void;
+
+    auto drawPoints(std::span<const PointInt2> points, const Color32& color) -> void;
+
+    // 端点使用 24.8 定点坐标
+    auto drawLine(const PointFixed2& begin, const PointFixed2& end, const Color& color, int thickness = 1) -> void;
+
+    auto drawLine(const Point2& begin, const Point2& end, const Color& color, int thickness = 1) -> void {
+        drawLine(begin.cast<Fixed>(), end.cast<Fixed>(), color, thickness);
+    }
+
+    // 与 FixedCanvas2D::drawPolygon 相同, 只裁剪到视图范围
+    auto drawPolygon(std::span<const Point2> points, const Color& color, float radians = 0, bool connect_first_last = true) -> void {
+        m_polyline_clipper.draw(points, m_rect, radians, connect_first_last, [&](const Point2& begin, const Point2& end) {
+            drawLine(begin, end, color);
+        });
+    }
+
+    auto drawPolygon(const PolylineSet2& polygons, const Color& color, float radians = 0) -> void {
+        for (auto polygon : polygons.polylines()) {
+            drawPolygon(polygon, color, radians);
+        }
+    }
+
+    auto drawPolyline(std::span<const Point2> points, const Color& color, float radians = 0) -> void {
+        drawPolygon(points, color, radians, false);
+    }
+
+    auto drawPolyline(const PolylineSet2& polylines, const Color& color, float radians = 0) -> void {
+        for (auto polyline : polylines.polylines()) {
+            drawPolyline(polyline, color, radians);
+        }
+    }
+
+private:
+    const uint8_t*  m_canvas = nullptr;   // 画布的像素, 用于判断两个视图是否属于同一画布
+    cv::Rect        m_rect;
+    cv::Mat         m_image;
+    PolylineClipper m_polyline_clipper;   // drawPolygon 使用
+};
+}   // namespace tg::ui
@@ -1,6 +1,15 @@
 #pragma once
 #include <tg/Color.h>
 #include <tg/Point.h>
+#include <tg/Polyline.h>
+#include <tg/PolylineSimplify.h>
+#include <tg/render/GlyphAtlas.h>
+#include <tg/render/ImageFilter.h>
+#include <tg/render/PointScatter.h>
+#include <tg/render/SpriteBatch.h>
+#include <tg/shm/FrameRing.h>
+#include <tg/ui/CanvasView.h>
+#include <tg/ui/PolylineClipper.h>
 #include <tg/ui/window.h>
 
 #include <cmath>
@@ -19,12 +28,19 @@ public:
         auto operator=(const Texture&) = delete;
         auto operator=(Texture&&)      = delete;
 
-        auto update(const cv::Mat& image) -> void;
+        // upload 为 false 时复用上次上传的纹理, 只提交 ImGui::Image
+        auto update(const cv::Mat& image, bool upload = true) -> void;
+
+        // 显存, 按上传的 RGBA 估算
+        auto memoryBytes() const {
+            return m_bytes;
+        }
 
         Point2 m_texturePos;
 
     private:
-        unsigned int m_textureID;
+        unsigned int m_textureID = 0;   // 第一次上传时创建, 无界面模式下不创建
+        size_t       m_bytes     = 0;
     };
 
     static constexpr auto k_default_width = 100;
@@ -33,8 +49,64 @@ public:
         resize(width, height);
     }
 
+    auto saveSnapshot(const std::filesystem::path& path) const -> bool override {
+        auto file = path;
+        file += ".png";
+        return cv::imwrite(file.string(), m_image);
+    }
+
+    auto memoryUsage(MemoryUsage& usage) const -> void override {
+        Window::memoryUsage(usage);
+        usage.add("画布", m_image.total() * m_image.elemSize());
+        usage.add("纹理", m_texture.memoryBytes());
+        if (m_frame_ring) {
+            usage.add("共享内存", m_frame_ring->memoryBytes());
+        }
+        usage.add("临时缓冲", scratchBytes());
+    }
+
+    // 释放绘制用的临时缓冲, 画布和纹理不能释放
+    auto trimMemory() -> size_t override {
+        auto bytes         = Window::trimMemory() + scratchBytes();
+        m_polyline_clipper = {};
+        m_text_batch       = {};
+        return bytes;
+    }
+
+    auto init() -> void override {
+        registerEvent("共享内存发布", [this]() {
+            if (m_frame_ring) {
+                disableSharedMemoryPublish();
+            }
+            else {
+                enableSharedMemoryPublish(std::format("tg-{}", m_name));
+            }
+        });
+    }
+
     auto impl_paint() -> void override {
-        m_texture.update(m_image);
+        if (m_texture_dirty) {
+            publishFrame();
+        }
+        m_texture.update(m_image, m_texture_dirty);
+        m_texture_dirty = false;
+    }
+
+    // 画布内容改变时发布到共享内存环形缓冲区, 其它进程使用 tg::shm::FrameRingReader 读取
+    auto enableSharedMemoryPublish(std::string_view name, uint32_t slot_count = shm::FrameRingWriter::k_default_slot_count) -> void {
+        m_frame_ring            = std::make_unique<shm::FrameRingWriter>(name, m_image.total() * m_image.elemSize(), slot_count);
+        m_frame_ring_name       = name;
+        m_frame_ring_slots      = slot_count;
+        m_frame_ring_generation = 0;
+        spdlog::info("shared memory publish: {}, {}x{}", name, m_image.cols, m_image.rows);
+        markDirty();
+    }
+
+    auto disableSharedMemoryPublish() -> void {
+        if (m_frame_ring) {
+            spdlog::info("shared memory publish stopped: {}", m_frame_ring->name());
+        }
+        m_frame_ring.reset();
     }
 
     auto width() const {
@@ -53,6 +125,7 @@ public:
             cv::Rect roi(0, 0, std::min(m_image.cols, oldImage.cols), std::min(m_image.rows, oldImage.rows));
             oldImage(roi).copyTo(m_image(roi));
         }
+        markDirty();
     }
 
     auto pointInCanvas(const PointInt2& p) const {
@@ -65,6 +138,25 @@ public:
 
     auto drawBackground(const Color& color = constants::white) -> void {
         m_image.setTo(ColorToCVBGR(color));
+        markDirty();
+    }
+
+    // 画布 (或其中一个区域) 的视图, 用于在多个线程中同时绘制不相交的区域. 调用即视为画布内容改变,
+    // 视图在 resize 之后失效
+    auto view() -> CanvasView {
+        markDirty();
+        return CanvasView(m_image);
+    }
+
+    auto view(const cv::Rect& rect) -> CanvasView {
+        markDirty();
+        return {m_image, rect};
+    }
+
+    // 对画布执行滤波流水线, 结果写回画布
+    auto applyFilters(render::FilterPipeline& pipeline) -> void {
+        pipeline.apply(m_image);
+        markDirty();
     }
 
     auto drawPoint(const PointInt2& p, const Color& color) {
@@ -72,37 +164,81 @@ public:
             throw tg_exception();
         }
         m_image.at<cv::Vec3b>(p.y, p.x) = cv::Vec3b(color.get_b8(), color.get_g8(), color.get_r8());
+        markDirty();
     }
 
-    auto drawLine(const Point2& begin, const Point2& end, const Color& color, int thickness = 1) {
-        cv::line(m_image, {std::lround(begin.x), std::lround(begin.y)}, {std::lround(end.x), std::lround(end.y)}, ColorToCVBGR(color), thickness, cv::LINE_AA);
+    // 批量绘制点, 画布以外的点忽略 (drawPoint 对画布以外的点抛出异常), 重叠时后面的点覆盖前面的点
+    auto drawPoints(std::span<const PointInt2> points, std::span<const Color32> colors) -> void {
+        render::scatterPoints(m_image, {0, 0}, points, colors);
+        markDirty();
     }
 
-    auto drawPolygon(const std::vector<Point2>& points, const Color& color, float radians = 0, bool connect_first_last = true) {
-        if (points.empty()) {
-            return;
+    auto drawPoints(std::span<const PointInt2> points, const Color32& color) -> void {
+        render::scatterPoints(m_image, {0, 0}, points, color);
+        markDirty();
+    }
+
+    // 端点使用 24.8 定点坐标, opencv 按 shift 位小数处理, 光栅化过程只有整数运算
+    auto drawLine(const PointFixed2& begin, const PointFixed2& end, const Color& color, int thickness = 1) -> void {
+        cv::line(m_image, {begin.x.raw(), begin.y.raw()}, {end.x.raw(), end.y.raw()}, ColorToCVBGR(color), thickness, cv::LINE_AA, Fixed::k_frac_bits);
+        markDirty();
+    }
+
+    auto drawLine(const Point2& begin, const Point2& end, const Color& color, int thickness = 1) -> void {
+        drawLine(begin.cast<Fixed>(), end.cast<Fixed>(), color, thickness);
+    }
+
+    // 按顺序连接各点, connect_first_last 为 true 时首尾相连; radians 不为 0 时绕第一个点旋转.
+    // 绘制前先去掉落在同一像素内的连续点, 再裁剪到画布范围, 只光栅化可见的线段
+    auto drawPolygon(std::span<const Point2> points, const Color& color, float radians = 0, bool connect_first_last = true) -> void {
+        m_polyline_clipper.draw(points, cv::Rect(0, 0, m_image.cols, m_image.rows), radians, connect_first_last, [&](const Point2& begin, const Point2& end) {
+            drawLine(begin, end, color);
+        });
+    }
+
+    // 按当前缩放比例取缓存的简化结果, tolerance 为允许的误差 (像素)
+    auto drawPolygon(PolylineLod& polygon, const Color& color, float tolerance = 0.5F, bool connect_first_last = true) -> void {
+        drawPolygon(polygon.get(tolerance), color, 0, connect_first_last);
+    }
+
+    auto drawPolygon(const PolylineSet2& polygons, const Color& color, float radians = 0) -> void {
+        for (auto polygon : polygons.polylines()) {
+            drawPolygon(polygon, color, radians);
         }
+    }
 
-        if (equalF(radians, 0)) {
-            for (auto i : std::views::iota(0ULL, points.size() - 1)) {
-                drawLine(points[i], points[i + 1], color);
-            }
-            if (connect_first_last) {
-                drawLine(points.back(), points.front(), color);
-            }
-            return;
+    auto drawPolyline(std::span<const Point2> points, const Color& color, float radians = 0) -> void {
+        drawPolygon(points, color, radians, false);
+    }
+
+    auto drawPolyline(const PolylineSet2& polylines, const Color& color, float radians = 0) -> void {
+        for (auto polyline : polylines.polylines()) {
+            drawPolyline(polyline, color, radians);
         }
+    }
 
-        const auto& pivot = points[0];
-        auto        pre   = pivot;
-        for (auto i : std::views::iota(1ULL, points.size())) {
-            auto next = points[i].rotated(pivot, radians);
-            drawLine(pre, next, color);
-            pre = next;
+    // 绘制一批文字, 之后 batch 被清空
+    auto drawText(render::TextBatch& batch) -> void {
+        if (batch.empty()) {
+            return;
         }
-        if (connect_first_last) {
-            drawLine(pre, pivot, color);
+        batch.draw(m_image);
+        markDirty();
+    }
+
+    // pos 为文字左上角; 绘制很多标签时应使用 TextBatch
+    auto drawText(render::GlyphAtlas& atlas, std::string_view utf8, const Point2& pos, const Color& color) -> void {
+        m_text_batch.add(atlas, utf8, pos, color);
+        drawText(m_text_batch);
+    }
+
+    // 绘制一批图像实例, 之后 batch 中的实例被清空, 注册的图像保留
+    auto drawSprites(render::SpriteBatch& batch, render::SpriteSampling sampling = render::SpriteSampling::Bilinear) -> void {
+        if (batch.empty()) {
+            return;
         }
+        batch.render(m_image, sampling);
+        markDirty();
     }
 
     auto getTexturePos() const {
@@ -125,8 +261,54 @@ public:
         return ret;
     }
 
+protected:
+    // 直接读写画布像素 (CV_8UC3, BGR), 调用即视为画布内容改变
+    auto mutableImage() -> cv::Mat& {
+        markDirty();
+        return m_image;
+    }
+
 private:
-    cv::Mat m_image;
-    Texture m_texture;
+    // 画布内容改变, 下一帧重新上传纹理
+    auto markDirty() -> void {
+        m_texture_dirty = true;
+        requestRedraw();
+    }
+
+    auto scratchBytes() const -> size_t {
+        return m_polyline_clipper.memoryBytes() + m_text_batch.memoryBytes();
+    }
+
+    auto publishFrame() -> void {
+        if (!m_frame_ring) {
+            return;
+        }
+        // 在 paint 中调用, 出错时停止发布, 不抛出异常
+        try {
+            auto bytes = m_image.total() * m_image.elemSize();
+            // 画布变大后需要重新创建, 使用新的名字 "名字-序号", 读者需要重新打开.
+            // 不能重用旧的名字: 读者可能还打开着旧的共享内存 (windows 上同名的映射保持旧的大小)
+            if (bytes > m_frame_ring->slotCapacity()) {
+                m_frame_ring.reset();
+                auto name    = std::format("{}-{}", m_frame_ring_name, ++m_frame_ring_generation);
+                m_frame_ring = std::make_unique<shm::FrameRingWriter>(name, bytes, m_frame_ring_slots);
+                spdlog::info("shared memory publish: {}, {}x{}", name, m_image.cols, m_image.rows);
+            }
+            m_frame_ring->publish(m_image.data, width(), height(), static_cast<size_t>(width()) * m_image.elemSize(), m_image.step, shm::FrameFormat::BGR8);
+        } catch (std::exception& e) {
+            spdlog::error("shared memory publish stopped: {}, {}", m_frame_ring_name, e.what());
+            m_frame_ring.reset();
+        }
+    }
+
+    cv::Mat                               m_image;
+    Texture                               m_texture;
+    bool                                  m_texture_dirty = true;
+    std::unique_ptr<shm::FrameRingWriter> m_frame_ring;   // 共享内存发布, 未开启时为空
+    std::string                           m_frame_ring_name;   // enableSharedMemoryPublish 的名字, 画布变大重新创建时加上序号
+    uint32_t                              m_frame_ring_slots      = shm::FrameRingWriter::k_default_slot_count;
+    uint32_t                              m_frame_ring_generation = 0;
+    PolylineClipper                       m_polyline_clipper;   // drawPolygon 使用
+    render::TextBatch                     m_text_batch;   // 单个 drawText 使用
 };
 }   // namespace tg::ui
@@ -0,0 +1,461 @@
+#include <tg/ui/InputRecorder.h>
+
+#include <bit>
+#include <imgui.h>
+#include <imgui_internal.h>
+#include <thread>
+
+namespace tg::ui {
+namespace {
+auto writeVarint(std::string& buffer, uint64_t v) {
+    constexpr auto k_mask = 0x7FU;
+    constexpr auto k_more = 0x80U;
+    while (v > k_mask) {
+        buffer.push_back(static_cast<char>((v & k_mask) | k_more));
+        v >>= 7U;
+    }
+    buffer.push_back(static_cast<char>(v));
+}
+
+auto writeFloat(std::string& buffer, float v) {
+    auto bits = std::bit_cast<uint32_t>(v);
+    for (auto i = 0U; i < 4U; i++) {
+        buffer.push_back(static_cast<char>((bits >> (i * 8U)) & 0xFFU));
+    }
+}
+
+auto writeString(std::string& buffer, std::string_view s) {
+    writeVarint(buffer, s.size());
+    buffer.append(s);
+}
+
+auto writeType(std::string& buffer, InputLog::RecordType type) {
+    buffer.push_back(static_cast<char>(type));
+}
+
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data)
+        : m_data(data) {}
+
+    auto empty() const {
+        return m_pos >= m_data.size();
+    }
+
+    auto u8() -> uint8_t {
+        if (empty()) {
+            throw tg_exception("input log truncated");
+        }
+        return static_cast<uint8_t>(m_data[m_pos++]);
+    }
+
+    auto varint() -> uint64_t {
+        uint64_t v     = 0;
+        auto     shift = 0U;
+        while (true) {
+            auto b = u8();
+            v |= static_cast<uint64_t>(b & 0x7FU) << shift;
+            if ((b & 0x80U) == 0) {
+                return v;
+            }
+            shift += 7U;
+            if (shift >= 64U) {
+                throw tg_exception("input log invalid varint");
+            }
+        }
+    }
+
+    auto f32() -> float {
+        uint32_t bits = 0;
+        for (auto i = 0U; i < 4U; i++) {
+            bits |= static_cast<uint32_t>(u8()) << (i * 8U);
+        }
+        return std::bit_cast<float>(bits);
+    }
+
+    auto str() -> std::string {
+        auto size = varint();
+        if (size > m_data.size() - m_pos) {
+            throw tg_exception("input log truncated");
+        }
+        auto s = std::string{m_data.substr(m_pos, size)};
+        m_pos += size;
+        return s;
+    }
+
+private:
+    std::string_view m_data;
+    size_t           m_pos = 0;
+};
+
+auto inputQueue() -> ImVector<ImGuiInputEvent>& {
+    return ImGui::GetCurrentContext()->InputEventsQueue;
+}
+}   // namespace
+
+auto InputRecordOptions::argumentValues(std::string_view arg) -> std::optional<size_t> {
+    if (arg == "--record" || arg == "--replay") {
+        return 1;
+    }
+    if (arg == "--replay-realtime") {
+        return 0;
+    }
+    return std::nullopt;
+}
+
+auto InputRecordOptions::parse(int argc, char** argv) -> InputRecordOptions {
+    InputRecordOptions options;
+    for (auto i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        auto             n   = argumentValues(arg);
+        if (!n) {
+            continue;
+        }
+        if (i + static_cast<int>(*n) >= argc) {
+            throw tg_exception("missing value: {}", arg);
+        }
+        if (arg == "--record") {
+            options.m_record_file = std::filesystem::path(argv[++i]);
+        }
+        else if (arg == "--replay") {
+            options.m_replay_file = std::filesystem::path(argv[++i]);
+        }
+        else {
+            options.m_realtime = true;
+        }
+    }
+    if (options.m_record_file && options.m_replay_file) {
+        throw tg_exception("--record and --replay can not be used together");
+    }
+    return options;
+}
+
+auto InputLog::load(const std::filesystem::path& path) -> std::vector<Frame> {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw tg_exception("open input log error: {}", path.string());
+    }
+    std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (!data.starts_with(k_magic) || data.size() <= k_magic.size() || static_cast<uint8_t>(data[k_magic.size()]) != k_version) {
+        throw tg_exception("invalid input log: {}", path.string());
+    }
+
+    std::vector<Frame> frames;
+    ByteReader         reader(std::string_view{data}.substr(k_magic.size() + 1));
+    int64_t            time_ns = 0;
+    while (!reader.empty()) {
+        auto type = static_cast<RecordType>(reader.u8());
+        if (type != RecordType::Frame && frames.empty()) {
+            throw tg_exception("invalid input log, record before first frame: {}", path.string());
+        }
+        switch (type) {
+            case RecordType::Frame: {
+                time_ns += static_cast<int64_t>(reader.varint());
+                auto& f        = frames.emplace_back();
+                f.m_time_ns    = time_ns;
+                f.m_delta_time = reader.f32();
+                break;
+            }
+            case RecordType::DisplaySize: {
+                auto w                        = reader.f32();
+                frames.back().m_display_size = std::pair{w, reader.f32()};
+                break;
+            }
+            case RecordType::MousePos:
+            case RecordType::MouseWheel: {
+                auto x = reader.f32();
+                frames.back().m_inputs.push_back({.m_type = type, .m_x = x, .m_y = reader.f32()});
+                break;
+            }
+            case RecordType::MouseButton:
+            case RecordType::Key: {
+                auto code = static_cast<uint32_t>(reader.varint());
+                frames.back().m_inputs.push_back({.m_type = type, .m_code = code, .m_down = reader.u8() != 0});
+                break;
+            }
+            case RecordType::Text:
+            case RecordType::MouseViewport:
+                frames.back().m_inputs.push_back({.m_type = type, .m_code = static_cast<uint32_t>(reader.varint())});
+                break;
+            case RecordType::Focus:
+                frames.back().m_inputs.push_back({.m_type = type, .m_down = reader.u8() != 0});
+                break;
+            case RecordType::WindowRect: {
+                auto& r         = frames.back().m_window_rects.emplace_back();
+                r.m_window_name = reader.str();
+                r.m_x           = reader.f32();
+                r.m_y           = reader.f32();
+                r.m_width       = reader.f32();
+                r.m_height      = reader.f32();
+                break;
+            }
+            case RecordType::Event: {
+                auto window_name = reader.str();
+                frames.back().m_events.push_back({.m_window_name = std::move(window_name), .m_event_name = reader.str()});
+                break;
+            }
+            default:
+                throw tg_exception("invalid input log record type: {}", static_cast<int>(type));
+        }
+    }
+    return frames;
+}
+
+auto InputLog::open(const std::filesystem::path& path) -> void {
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        throw tg_exception("open input log error: {}", path.string());
+    }
+    m_file.write(k_magic.data(), static_cast<std::streamsize>(k_magic.size()));
+    m_file.put(static_cast<char>(k_version));
+    m_last_time_ns = 0;
+}
+
+auto InputLog::write(const Frame& frame) -> void {
+    m_buffer.clear();
+    writeType(m_buffer, RecordType::Frame);
+    writeVarint(m_buffer, static_cast<uint64_t>(std::max<int64_t>(frame.m_time_ns - m_last_time_ns, 0)));
+    writeFloat(m_buffer, frame.m_delta_time);
+    m_last_time_ns = frame.m_time_ns;
+
+    if (frame.m_display_size) {
+        writeType(m_buffer, RecordType::DisplaySize);
+        writeFloat(m_buffer, frame.m_display_size->first);
+        writeFloat(m_buffer, frame.m_display_size->second);
+    }
+    for (auto& i : frame.m_inputs) {
+        writeType(m_buffer, i.m_type);
+        switch (i.m_type) {
+            case RecordType::MousePos:
+            case RecordType::MouseWheel:
+                writeFloat(m_buffer, i.m_x);
+                writeFloat(m_buffer, i.m_y);
+                break;
+            case RecordType::MouseButton:
+            case RecordType::Key:
+                writeVarint(m_buffer, i.m_code);
+                m_buffer.push_back(static_cast<char>(i.m_down));
+                break;
+            case RecordType::Text:
+            case RecordType::MouseViewport:
+                writeVarint(m_buffer, i.m_code);
+                break;
+            case RecordType::Focus:
+                m_buffer.push_back(static_cast<char>(i.m_down));
+                break;
+            default:
+                throw tg_exception("invalid input record type: {}", static_cast<int>(i.m_type));
+        }
+    }
+    for (auto& r : frame.m_window_rects) {
+        writeType(m_buffer, RecordType::WindowRect);
+        writeString(m_buffer, r.m_window_name);
+        writeFloat(m_buffer, r.m_x);
+        writeFloat(m_buffer, r.m_y);
+        writeFloat(m_buffer, r.m_width);
+        writeFloat(m_buffer, r.m_height);
+    }
+    for (auto& e : frame.m_events) {
+        writeType(m_buffer, RecordType::Event);
+        writeString(m_buffer, e.m_window_name);
+        writeString(m_buffer, e.m_event_name);
+    }
+    m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+}
+
+auto InputLog::close() -> void {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+}
+
+auto InputRecorder::startRecording(const std::filesystem::path& path) -> void {
+    stop();
+    m_log.open(path);
+    m_recording     = true;
+    m_start         = std::chrono::steady_clock::now();
+    m_last_event_id = 0;
+    m_last_display_size.reset();
+    m_window_rects.clear();
+    spdlog::info("input recording: {}", path.string());
+}
+
+auto InputRecorder::startReplay(const std::filesystem::path& path, bool realtime) -> void {
+    stop();
+    m_replay_frames = InputLog::load(path);
+    m_replaying     = !m_replay_frames.empty();
+    m_realtime      = realtime;
+    m_replay_index  = 0;
+    m_replay_keep   = 0;
+    m_window_rects.clear();
+    m_start = std::chrono::steady_clock::now();
+    spdlog::info("input replay: {}, {} frame(s), {}", path.string(), m_replay_frames.size(), realtime ? "realtime" : "full speed");
+}
+
+auto InputRecorder::stop() -> void {
+    if (m_recording) {
+        m_log.close();
+        spdlog::info("input recording stopped");
+    }
+    m_recording = false;
+    m_replaying = false;
+    m_replay_frames.clear();
+}
+
+auto InputRecorder::beginFrame() -> void {
+    auto& io    = ImGui::GetIO();
+    auto& queue = inputQueue();
+
+    if (m_replaying) {
+        auto& frame = m_replay_frames[m_replay_index];
+        if (m_realtime) {
+            std::this_thread::sleep_until(m_start + std::chrono::nanoseconds(frame.m_time_ns));
+        }
+
+        // 丢弃平台后端本帧加入的输入, 只保留上一帧未处理完的回放输入
+        if (queue.Size > m_replay_keep) {
+            queue.resize(m_replay_keep);
+        }
+        if (frame.m_delta_time > 0) {
+            io.DeltaTime = frame.m_delta_time;
+        }
+        if (frame.m_display_size) {
+            io.DisplaySize = ImVec2(frame.m_display_size->first, frame.m_display_size->second);
+        }
+        for (auto& r : frame.m_window_rects) {
+            m_window_rects.insert_or_assign(r.m_window_name, r);
+        }
+        for (auto& i : frame.m_inputs) {
+            switch (i.m_type) {
+                case InputLog::RecordType::MousePos:
+                    io.AddMousePosEvent(i.m_x, i.m_y);
+                    break;
+                case InputLog::RecordType::MouseWheel:
+                    io.AddMouseWheelEvent(i.m_x, i.m_y);
+                    break;
+                case InputLog::RecordType::MouseButton:
+                    io.AddMouseButtonEvent(static_cast<int>(i.m_code), i.m_down);
+                    break;
+                case InputLog::RecordType::Key:
+                    io.AddKeyEvent(static_cast<ImGuiKey>(i.m_code), i.m_down);
+                    break;
+                case InputLog::RecordType::Text:
+                    io.AddInputCharacter(i.m_code);
+                    break;
+                case InputLog::RecordType::Focus:
+                    io.AddFocusEvent(i.m_down);
+                    break;
+                case InputLog::RecordType::MouseViewport:
+                    io.AddMouseViewportEvent(i.m_code);
+                    break;
+                default:
+                    break;
+            }
+        }
+        return;
+    }
+
+    if (!m_recording) {
+        return;
+    }
+    m_frame              = {};
+    m_frame.m_time_ns    = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+    m_frame.m_delta_time = io.DeltaTime;
+    auto display_size    = std::pair{io.DisplaySize.x, io.DisplaySize.y};
+    if (display_size != m_last_display_size) {
+        m_frame.m_display_size = display_size;
+        m_last_display_size    = display_size;
+    }
+
+    // ImGui 会把同一帧的多个输入拆分到后续帧处理, 用 EventId 跳过已经录制过的输入
+    for (auto& e : queue) {
+        if (e.EventId <= m_last_event_id) {
+            continue;
+        }
+        m_last_event_id = e.EventId;
+        switch (e.Type) {
+            case ImGuiInputEventType_MousePos:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::MousePos, .m_x = e.MousePos.PosX, .m_y = e.MousePos.PosY});
+                break;
+            case ImGuiInputEventType_MouseWheel:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::MouseWheel, .m_x = e.MouseWheel.WheelX, .m_y = e.MouseWheel.WheelY});
+                break;
+            case ImGuiInputEventType_MouseButton:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::MouseButton, .m_code = static_cast<uint32_t>(e.MouseButton.Button), .m_down = e.MouseButton.Down});
+                break;
+            case ImGuiInputEventType_MouseViewport:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::MouseViewport, .m_code = e.MouseViewport.HoveredViewportID});
+                break;
+            case ImGuiInputEventType_Key:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::Key, .m_code = static_cast<uint32_t>(e.Key.Key), .m_down = e.Key.Down});
+                break;
+            case ImGuiInputEventType_Text:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::Text, .m_code = e.Text.Char});
+                break;
+            case ImGuiInputEventType_Focus:
+                m_frame.m_inputs.push_back({.m_type = InputLog::RecordType::Focus, .m_down = e.AppFocused.Focused});
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+auto InputRecorder::afterNewFrame() -> void {
+    if (m_replaying) {
+        m_replay_keep = inputQueue().Size;
+    }
+}
+
+auto InputRecorder::endFrame() -> void {
+    if (m_recording) {
+        m_log.write(m_frame);
+    }
+    if (m_replaying && ++m_replay_index >= m_replay_frames.size()) {
+        spdlog::info("input replay finished: {} frame(s), {}", m_replay_frames.size(), formatReadableDuration(std::chrono::steady_clock::now() - m_start));
+        stop();
+    }
+}
+
+auto InputRecorder::replayEvents() const -> std::span<const InputLog::TriggeredEvent> {
+    if (!m_replaying) {
+        return {};
+    }
+    return m_replay_frames[m_replay_index].m_events;
+}
+
+auto InputRecorder::recordEvent(std::string_view window_name, std::string_view event_name) -> bool {
+    if (m_replaying) {
+        return false;
+    }
+    if (m_recording) {
+        m_frame.m_events.push_back({.m_window_name = std::string{window_name}, .m_event_name = std::string{event_name}});
+    }
+    return true;
+}
+
+auto InputRecorder::beforeBeginWindow(std::string_view window_name) -> void {
+    if (!m_replaying) {
+        return;
+    }
+    if (auto it = m_window_rects.find(window_name); it != m_window_rects.end()) {
+        ImGui::SetNextWindowPos(ImVec2(it->second.m_x, it->second.m_y), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(ImVec2(it->second.m_width, it->second.m_height), ImGuiCond_Always);
+    }
+}
+
+auto InputRecorder::afterBeginWindow(std::string_view window_name) -> void {
+    if (!m_recording) {
+        return;
+    }
+    auto pos  = ImGui::GetWindowPos();
+    auto size = ImGui::GetWindowSize();
+    auto it   = m_window_rects.find(window_name);
+    if (it != m_window_rects.end() && it->second.m_x == pos.x && it->second.m_y == pos.y && it->second.m_width == size.x && it->second.m_height == size.y) {
+        return;
+    }
+    InputLog::WindowRect rect{.m_window_name = std::string{window_name}, .m_x = pos.x, .m_y = pos.y, .m_width = size.x, .m_height = size.y};
+    m_frame.m_window_rects.push_back(rect);
+    m_window_rects.insert_or_assign(std::string{window_name}, std::move(rect));
+}
+}   // namespace tg::ui
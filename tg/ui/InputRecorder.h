@@ -0,0 +1,146 @@
+#pragma once
+#include <tg/utils.h>
+
+#include <fstream>
+#include <optional>
+#include <span>
+
+namespace tg::ui {
+// 输入录制与回放的命令行参数
+// --record 文件          录制输入
+// --replay 文件          回放输入, 默认全速回放 (使用录制时的 DeltaTime)
+// --replay-realtime      按录制时的时间间隔回放
+class InputRecordOptions {
+public:
+    // 只读取录制相关的参数, 忽略其它参数
+    static auto parse(int argc, char** argv) -> InputRecordOptions;
+
+    // 参数名是否属于录制相关参数, 返回参数需要的值的个数, 不属于时返回空
+    static auto argumentValues(std::string_view arg) -> std::optional<size_t>;
+
+    std::optional<std::filesystem::path> m_record_file;
+    std::optional<std::filesystem::path> m_replay_file;
+    bool                                 m_realtime = false;
+};
+
+// 输入日志, 二进制格式:
+// 文件头 "TGIR" + 版本号(u8), 之后是一系列记录, 每条记录以 u8 类型开头,
+// 整数使用 LEB128 变长编码, 浮点数为 4 字节小端, 字符串为长度 + UTF-8 字节.
+// 每帧以 Frame 记录开始, 之后直到下一个 Frame 记录的内容都属于这一帧.
+class InputLog {
+public:
+    enum class RecordType : uint8_t {
+        Frame         = 1,    // 与上一帧的时间差(ns), DeltaTime
+        DisplaySize   = 2,    // 宽, 高
+        MousePos      = 3,    // x, y
+        MouseWheel    = 4,    // x, y
+        MouseButton   = 5,    // 按键, 是否按下
+        Key           = 6,    // ImGuiKey, 是否按下
+        Text          = 7,    // 字符
+        Focus         = 8,    // 是否获得焦点
+        WindowRect    = 9,    // 窗口名, x, y, 宽, 高
+        Event         = 10,   // 窗口名, 事件名
+        MouseViewport = 11,   // 鼠标所在的视口 ID (由窗口名哈希得到, 多次运行一致)
+    };
+
+    // ImGui 输入事件
+    class Input {
+    public:
+        RecordType m_type;
+        float      m_x    = 0;   // 坐标, 滚轮
+        float      m_y    = 0;
+        uint32_t   m_code = 0;   // 鼠标按键, ImGuiKey, 字符, 视口 ID
+        bool       m_down = false;
+    };
+
+    class WindowRect {
+    public:
+        std::string m_window_name;
+        float       m_x;
+        float       m_y;
+        float       m_width;
+        float       m_height;
+    };
+
+    class TriggeredEvent {
+    public:
+        std::string m_window_name;
+        std::string m_event_name;
+    };
+
+    class Frame {
+    public:
+        int64_t                                m_time_ns    = 0;   // 相对于录制开始
+        float                                  m_delta_time = 0;
+        std::optional<std::pair<float, float>> m_display_size;
+        std::vector<Input>                     m_inputs;
+        std::vector<WindowRect>                m_window_rects;
+        std::vector<TriggeredEvent>            m_events;
+    };
+
+    static constexpr std::string_view k_magic   = "TGIR";
+    static constexpr uint8_t          k_version = 1;
+
+    static auto load(const std::filesystem::path& path) -> std::vector<Frame>;
+
+    // 追加写入, 每帧结束时写入文件
+    auto open(const std::filesystem::path& path) -> void;
+    auto write(const Frame& frame) -> void;
+    auto close() -> void;
+
+private:
+    std::ofstream m_file;
+    int64_t       m_last_time_ns = 0;
+    std::string   m_buffer;
+};
+
+// 在帧循环中录制或回放 ImGui 的输入, 有界面和无界面模式都可以使用.
+// 调用顺序: 平台后端 NewFrame -> beginFrame -> ImGui::NewFrame -> afterNewFrame -> 绘制 -> endFrame
+class InputRecorder {
+public:
+    auto startRecording(const std::filesystem::path& path) -> void;
+    auto startReplay(const std::filesystem::path& path, bool realtime) -> void;
+    auto stop() -> void;
+
+    auto isRecording() const {
+        return m_recording;
+    }
+
+    auto isReplaying() const {
+        return m_replaying;
+    }
+
+    auto replayFrameCount() const {
+        return m_replay_frames.size();
+    }
+
+    // 录制: 保存本帧新增的输入事件; 回放: 用日志中的输入替换平台输入
+    auto beginFrame() -> void;
+    auto afterNewFrame() -> void;
+    auto endFrame() -> void;
+
+    // 回放时本帧需要触发的事件
+    auto replayEvents() const -> std::span<const InputLog::TriggeredEvent>;
+
+    // 用户通过界面触发的事件, 返回是否应该执行 (回放时界面触发的事件由日志代替)
+    auto recordEvent(std::string_view window_name, std::string_view event_name) -> bool;
+
+    // 在 ImGui::Begin 之前和之后调用, 录制或回放窗口位置和大小
+    auto beforeBeginWindow(std::string_view window_name) -> void;
+    auto afterBeginWindow(std::string_view window_name) -> void;
+
+private:
+    bool                                       m_recording = false;
+    bool                                       m_replaying = false;
+    bool                                       m_realtime  = false;
+    InputLog                                   m_log;
+    InputLog::Frame                            m_frame;
+    std::chrono::steady_clock::time_point      m_start;
+    unsigned int                               m_last_event_id = 0;
+    std::optional<std::pair<float, float>>     m_last_display_size;
+    unordered_map_string<InputLog::WindowRect> m_window_rects;
+    std::vector<InputLog::Frame>               m_replay_frames;
+    size_t                                     m_replay_index = 0;
+    int                                        m_replay_keep  = 0;   // 上一帧 ImGui 未处理完 (拆分到后续帧) 的回放输入个数
+};
+}   // namespace tg::ui
@@ -0,0 +1,58 @@
+#pragma once
+#include <tg/Polyline.h>
+#include <tg/PolylineSimplify.h>
+
+#include <opencv2/opencv.hpp>
+#include <span>
+
+namespace tg::ui {
+// FixedCanvas2D 和 CanvasView 绘制折线的公共部分: 旋转, 去掉落在同一像素内的连续点, 裁剪到目标范围,
+// 只把可见的线段交给调用者光栅化. 临时缓冲在多次调用之间复用
+class PolylineClipper {
+public:
+    static constexpr auto k_clip_guard = 8;   // 裁剪范围比目标范围大的像素数, 线宽和抗锯齿不会在边缘被截断
+
+    // 按顺序连接各点, connect_first_last 为 true 时首尾相连; radians 不为 0 时绕第一个点旋转.
+    // bounds 为目标范围 (画布坐标), 对每条可见线段调用 draw_line(begin, end), 只剩一个点时 begin == end
+    template <typename DrawLine>
+    auto draw(std::span<const Point2> points, const cv::Rect& bounds, float radians, bool connect_first_last, DrawLine draw_line) -> void {
+        if (points.empty() || bounds.empty()) {
+            return;
+        }
+
+        if (!equalF(radians, 0)) {
+            const auto& pivot = points[0];
+            m_rotated.assign(points.begin(), points.end());
+            for (auto& p : m_rotated | std::views::drop(1)) {
+                p.rotate(pivot, radians);
+            }
+            points = m_rotated;
+        }
+
+        decimatePixelSnap(points, m_decimated);
+        m_clipped.clear();
+        auto guard  = static_cast<float>(k_clip_guard);
+        auto closed = connect_first_last && m_decimated.size() > 2;
+        auto min    = Point2(static_cast<float>(bounds.x) - guard, static_cast<float>(bounds.y) - guard);
+        auto max    = Point2(static_cast<float>(bounds.x + bounds.width) + guard, static_cast<float>(bounds.y + bounds.height) + guard);
+        clipPolyline(m_decimated, min, max, m_clipped, closed);
+        for (auto line : m_clipped.polylines()) {
+            if (line.size() == 1) {
+                draw_line(line[0], line[0]);
+            }
+            for (size_t i = 0; i + 1 < line.size(); i++) {
+                draw_line(line[i], line[i + 1]);
+            }
+        }
+    }
+
+    auto memoryBytes() const {
+        return (m_rotated.capacity() + m_decimated.capacity()) * sizeof(Point2) + m_clipped.memoryBytes();
+    }
+
+private:
+    std::vector<Point2> m_rotated;
+    std::vector<Point2> m_decimated;
+    PolylineSet2        m_clipped;
+};
+}   // namespace tg::ui
@@ -0,0 +1,265 @@
+#include <tg/ui/headless.h>
+#include <tg/ui/window.h>
+
+#include <algorithm>
+#include <charconv>
+#include <imgui.h>
+#include <numeric>
+
+namespace tg::ui {
+namespace {
+auto parseNumber(std::string_view arg, std::string_view value) -> size_t {
+    size_t n     = 0;
+    auto [p, ec] = std::from_chars(value.data(), value.data() + value.size(), n);
+    if (ec != std::errc{} || p != value.data() + value.size()) {
+        throw tg_exception("invalid number: {} {}", arg, value);
+    }
+    return n;
+}
+
+// 耗时统计: 最小, 最大, 平均和分位数 (纳秒)
+auto summarize(std::vector<int64_t> ns) -> Json {
+    if (ns.empty()) {
+        return Json::object();
+    }
+    auto sum = std::accumulate(ns.begin(), ns.end(), 0LL);
+    std::ranges::sort(ns);
+    auto percentile = [&](double p) {
+        auto i = static_cast<size_t>(p * static_cast<double>(ns.size() - 1) + 0.5);
+        return ns[std::min(i, ns.size() - 1)];
+    };
+    return Json::object({
+        {"min_ns", ns.front()},
+        {"max_ns", ns.back()},
+        {"mean_ns", sum / static_cast<int64_t>(ns.size())},
+        {"p50_ns", percentile(0.50)},
+        {"p95_ns", percentile(0.95)},
+        {"p99_ns", percentile(0.99)},
+        {"total_ns", sum},
+    });
+}
+}   // namespace
+
+auto HeadlessOptions::parse(int argc, char** argv) -> std::optional<HeadlessOptions> {
+    std::vector<std::string_view> args(argv + 1, argv + argc);
+    if (std::ranges::find(args, "--headless") == args.end()) {
+        return std::nullopt;
+    }
+
+    HeadlessOptions options;
+    for (size_t i = 0; i < args.size(); i++) {
+        auto arg   = args[i];
+        auto value = [&]() {
+            if (i + 1 >= args.size()) {
+                throw tg_exception("missing value: {}", arg);
+            }
+            return args[++i];
+        };
+        if (arg == "--headless") {
+        }
+        else if (auto n = InputRecordOptions::argumentValues(arg); n) {
+            i += *n;
+        }
+        else if (auto n = LogOptions::argumentValues(arg); n) {
+            i += *n;
+        }
+        else if (arg == "--component") {
+            options.m_components.emplace_back(value());
+        }
+        else if (arg == "--frames") {
+            options.m_frames = parseNumber(arg, value());
+        }
+        else if (arg == "--dump") {
+            options.m_dump_dir = std::filesystem::path(value());
+        }
+        else if (arg == "--dump-every") {
+            options.m_dump_every = parseNumber(arg, value());
+        }
+        else if (arg == "--stats") {
+            options.m_stats_file = std::filesystem::path(value());
+        }
+        else if (arg == "--event") {
+            auto v   = value();
+            auto pos = v.rfind('@');
+            if (pos == std::string_view::npos) {
+                throw tg_exception("invalid event, expected 事件名@帧号: {}", v);
+            }
+            options.m_events.emplace_back(parseNumber(arg, v.substr(pos + 1)), std::string{v.substr(0, pos)});
+        }
+        else if (arg == "--size") {
+            auto v   = value();
+            auto pos = v.find('x');
+            if (pos == std::string_view::npos) {
+                throw tg_exception("invalid size, expected 宽x高: {}", v);
+            }
+            options.m_display_width  = static_cast<int>(parseNumber(arg, v.substr(0, pos)));
+            options.m_display_height = static_cast<int>(parseNumber(arg, v.substr(pos + 1)));
+        }
+        else {
+            throw tg_exception("unknown argument: {}", arg);
+        }
+    }
+    if (options.m_frames == 0) {
+        throw tg_exception("--frames must be greater than 0");
+    }
+    options.m_input = InputRecordOptions::parse(argc, argv);
+    return options;
+}
+
+auto MainWindow::runHeadless(const HeadlessOptions& options) -> int {
+    m_headless = true;
+
+    IMGUI_CHECKVERSION();
+    if (!ImGui::CreateContext()) {
+        spdlog::error("imgui CreateContext error");
+        return 1;
+    }
+    ImGuiIO& io    = ImGui::GetIO();
+    io.IniFilename = nullptr;   // 不读写 imgui.ini, 保证每次运行的布局一致
+    io.DisplaySize = ImVec2(static_cast<float>(options.m_display_width), static_cast<float>(options.m_display_height));
+    io.DeltaTime   = 1.F / 60.F;
+    io.Fonts->Build();
+
+    auto components = options.m_components;
+    if (components.empty()) {
+        for (auto& [name, _] : m_components) {
+            components.push_back(name);
+        }
+    }
+
+    std::vector<std::string>  window_names;
+    std::vector<WindowHandle> window_handles;
+    try {
+        for (auto& component_name : components) {
+            auto window_name = uniqueWindowName(component_name);
+            window_handles.push_back(addWindow(component_name, window_name));
+            window_names.push_back(window_name);
+        }
+        // 按帧号回放和统计, 不等到窗口可见再初始化, 后台初始化也在第一帧之前完成
+        for (auto h : window_handles) {
+            getWindow(h)->ensureInit();
+        }
+        for (auto h : window_handles) {
+            getWindow(h)->waitBackgroundInit();
+        }
+    } catch (std::exception& e) {
+        spdlog::error("headless create window error: {}", e.what());
+        return 1;
+    }
+
+    try {
+        startInputRecorder(options.m_input);
+    } catch (std::exception& e) {
+        spdlog::error("input recorder error: {}", e.what());
+        return 1;
+    }
+    auto frames = options.m_frames.value_or(m_input_recorder.isReplaying() ? m_input_recorder.replayFrameCount() : 1);
+
+    if (options.m_dump_dir) {
+        std::filesystem::create_directories(*options.m_dump_dir);
+    }
+    auto dump = [&](size_t frame) {
+        for (size_t i = 0; i < window_handles.size(); i++) {
+            getWindow(window_handles[i])->saveSnapshot(*options.m_dump_dir / std::format("{}-{:06}", window_names[i], frame));
+        }
+    };
+
+    std::vector<int64_t>              frame_ns;
+    std::vector<std::vector<int64_t>> prepare_ns(window_names.size());
+    std::vector<std::vector<int64_t>> paint_ns(window_names.size());
+    frame_ns.reserve(frames);
+    for (size_t i = 0; i < window_names.size(); i++) {
+        prepare_ns[i].reserve(frames);
+        paint_ns[i].reserve(frames);
+    }
+
+    spdlog::info("headless: {} window(s), {} frame(s)", window_names.size(), frames);
+    for (size_t frame = 0; frame < frames; frame++) {
+        auto frame_start = std::chrono::steady_clock::now();
+        io.DeltaTime     = 1.F / 60.F;
+        m_frame_arena.reset();
+        m_input_recorder.beginFrame();
+        ImGui::NewFrame();
+        m_input_recorder.afterNewFrame();
+        triggerReplayEvents();
+        dispatchPostedEvents();
+
+        for (auto& e : options.m_events) {
+            if (e.m_frame != frame) {
+                continue;
+            }
+            for (size_t i = 0; i < window_handles.size(); i++) {
+                const auto& w = getWindow(window_handles[i]);
+                if (std::ranges::any_of(w->m_events.m_event, [&](auto& item) { return item.m_event_name == e.m_event_name; }) && m_input_recorder.recordEvent(window_names[i], e.m_event_name)) {
+                    w->callEvent(e.m_event_name);
+                }
+            }
+        }
+
+        prepareWindows();
+        for (size_t i = 0; i < window_names.size(); i++) {
+            const auto& w = getWindow(window_handles[i]);
+            paintWindow(*w);
+            prepare_ns[i].push_back(w->m_prepare_time.count());
+            paint_ns[i].push_back(w->m_paint_time.count());
+        }
+
+        ImGui::Render();
+        for (auto h : window_handles) {
+            getWindow(h)->afterAllPaint();
+        }
+        m_input_recorder.endFrame();
+        frame_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame_start).count());
+
+        if (options.m_dump_dir && options.m_dump_every > 0 && (frame + 1) % options.m_dump_every == 0) {
+            dump(frame);
+        }
+    }
+    if (options.m_dump_dir && (options.m_dump_every == 0 || frames % options.m_dump_every != 0)) {
+        dump(frames - 1);
+    }
+    m_input_recorder.stop();
+
+    auto total = summarize(frame_ns);
+    spdlog::info("headless finished: mean {}, p99 {}", formatReadableDuration(std::chrono::nanoseconds(total["mean_ns"].get<int64_t>())), formatReadableDuration(std::chrono::nanoseconds(total["p99_ns"].get<int64_t>())));
+
+    if (options.m_stats_file) {
+        auto windows = Json::array();
+        for (size_t i = 0; i < window_names.size(); i++) {
+            const auto& w = getWindow(window_handles[i]);
+            MemoryUsage usage;
+            w->memoryUsage(usage);
+            auto memory = Json::object({{"total", usage.total()}});
+            for (const auto& item : usage.m_items) {
+                memory[item.m_category] = item.m_bytes;
+            }
+            windows.push_back(Json::object({
+                {"window name", window_names[i]},
+                {"component name", w->m_component_name},
+                {"memory", memory},
+                {"prepare", summarize(prepare_ns[i])},
+                {"prepare_ns", prepare_ns[i]},
+                {"paint", summarize(paint_ns[i])},
+                {"paint_ns", paint_ns[i]},
+            }));
+        }
+        Json stats = Json::object({
+            {"frames", frames},
+            {"frame", total},
+            {"frame_ns", frame_ns},
+            {"windows", windows},
+        });
+        std::ofstream file(*options.m_stats_file);
+        if (!file.is_open()) {
+            spdlog::error("headless open stats file error: {}", options.m_stats_file->string());
+            return 1;
+        }
+        file << stats.dump(4);
+    }
+
+    m_windows.clear();
+    m_window_names.clear();
+    ImGui::DestroyContext();
+    return 0;
+}
+}   // namespace tg::ui
@@ -0,0 +1,35 @@
+#pragma once
+#include <tg/ui/InputRecorder.h>
+#include <tg/utils.h>
+
+#include <optional>
+
+namespace tg::ui {
+// 无界面批处理模式的命令行参数, 例如:
+// TinyGraphics --headless --component Bresenham直线算法 --frames 1000 --dump out/ --stats stats.json
+class HeadlessOptions {
+public:
+    // --event 事件名@帧号, 在指定帧触发所有窗口中同名的事件
+    class ScheduledEvent {
+    public:
+        size_t      m_frame;
+        std::string m_event_name;
+    };
+
+    static constexpr auto k_default_display_width  = 1280;
+    static constexpr auto k_default_display_height = 720;
+
+    // 没有 --headless 参数时返回空, 参数错误时抛出异常
+    static auto parse(int argc, char** argv) -> std::optional<HeadlessOptions>;
+
+    std::vector<std::string>             m_components;                                // --component, 可重复
+    std::optional<size_t>                m_frames;                                    // --frames, 默认 1 帧, 回放时默认为录制的帧数
+    std::optional<std::filesystem::path> m_dump_dir;                                  // --dump, 输出最后一帧的图像
+    size_t                               m_dump_every = 0;                            // --dump-every, 每 N 帧输出一次图像, 0 表示只输出最后一帧
+    std::optional<std::filesystem::path> m_stats_file;                                // --stats, 每帧耗时统计 (json)
+    std::vector<ScheduledEvent>          m_events;                                    // --event
+    int                                  m_display_width  = k_default_display_width;   // --size 宽x高
+    int                                  m_display_height = k_default_display_height;
+    InputRecordOptions                   m_input;                                     // --record, --replay, --replay-realtime
+};
+}   // namespace tg::ui
@@ -1,18 +1,25 @@
+#include <tg/PhaseProfiler.h>
+#include <tg/log.h>
+#include <tg/parallel.h>
+#include <tg/ui/headless.h>
 #include <tg/ui/window.h>
 
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
+#include <imgui_internal.h>
 #include <imgui_impl_opengl3.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#include <unordered_set>
 
+#ifdef _WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#endif
 
 namespace tg::ui {
 namespace {
-auto init_imgui() {
+auto init_imgui(PhaseProfiler& profiler, const std::string& glyph_text) {
     glfwSetErrorCallback([](int error, const char* description) {
         spdlog::error("GLFW error {}: {}", error, description);
         std::abort();
@@ -37,6 +44,7 @@ auto init_imgui() {
         std::abort();
     }
     glfwMakeContextCurrent(window);
+    profiler.mark("GLFW");
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
@@ -65,12 +73,29 @@ auto init_imgui() {
     glfwGetWindowContentScale(window, &xscale, &yscale);
     auto scale = std::max(xscale, yscale);
     style.ScaleAllSizes(scale);
+    profiler.mark("ImGui");
+
+    // 完整的中文字符集有两万多个字, 生成图集需要数秒. 只加载常用字和界面中用到的字 (组件名, 配置中的 "字体额外字符")
+    static ImVector<ImWchar> ranges;   // 需要保留到图集生成之后
+    ImFontGlyphRangesBuilder builder;
+    builder.AddRanges(io.Fonts->GetGlyphRangesChineseSimplifiedCommon());
+    builder.AddText(glyph_text.c_str());
+    builder.BuildRanges(&ranges);
+
+    // 中文字形的水平过采样对清晰度帮助不大, 关闭后图集小一半
+    ImFontConfig config;
+    config.OversampleH = 1;
+    config.OversampleV = 1;
+    config.PixelSnapH  = true;
 
     constexpr auto k_font_size = 20.F;
-    if (!io.Fonts->AddFontFromFileTTF(R"(c:\Windows\Fonts\msyh.ttc)", k_font_size * scale, nullptr, io.Fonts->GetGlyphRangesChineseFull())) {
+    if (!io.Fonts->AddFontFromFileTTF(R"(c:\Windows\Fonts\msyh.ttc)", k_font_size * scale, &config, ranges.Data)) {
         spdlog::error("imgui AddFontFromFileTTF error");
         std::abort();
     }
+    // 否则在第一帧创建纹理时才生成
+    io.Fonts->Build();
+    profiler.mark("字体");
 
     // Setup Platform/Renderer backends
     if (!ImGui_ImplGlfw_InitForOpenGL(window, true)) {
@@ -81,29 +106,59 @@ auto init_imgui() {
         spdlog::error("imgui ImGui_ImplOpenGL3_Init error");
         std::abort();
     }
-}
-
-auto init_spdlog() {
-    system("chcp 65001");
-    system("cls");
-
-    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    console_sink->set_level(spdlog::level::debug);
-    auto logger = std::make_shared<spdlog::logger>("console", console_sink);
-    spdlog::set_default_logger(logger);
-    // [时间戳] [日志级别] [线程ID] 消息
-    console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%t] %v");
+    profiler.mark("后端");
 }
 }   // namespace
 
-auto MainWindow::main(int /*argc*/, char** /*argv*/) -> int {
+auto MainWindow::main(int argc, char** argv) -> int {
     m_component_name = "TinyGraphics";
     m_name           = m_component_name;
     m_open           = true;
 
-    init_spdlog();
-    init_imgui();
+    PhaseProfiler startup;
+    LogOptions    log_options;
+    try {
+        log_options = LogOptions::parse(argc, argv);
+    } catch (std::exception& e) {
+        initLogging();
+        spdlog::error("command line error: {}", e.what());
+        spdlog::shutdown();
+        return 1;
+    }
+    initLogging(log_options);
+    startup.mark("日志");
+
+    std::optional<HeadlessOptions> headless;
+    InputRecordOptions             input_record;
+    try {
+        headless     = HeadlessOptions::parse(argc, argv);
+        input_record = InputRecordOptions::parse(argc, argv);
+    } catch (std::exception& e) {
+        spdlog::error("command line error: {}", e.what());
+        spdlog::shutdown();
+        return 1;
+    }
+    if (headless) {
+        auto ret = runHeadless(*headless);
+        spdlog::shutdown();
+        return ret;
+    }
+
+    startup.mark("命令行");
+
+    init_imgui(startup, fontGlyphText());
     loadWindowsConfig();
+    loadFrameLoopConfig();
+    loadMemoryBudget();
+    try {
+        startInputRecorder(input_record);
+    } catch (std::exception& e) {
+        spdlog::error("input recorder error: {}", e.what());
+        spdlog::shutdown();
+        return 1;
+    }
+    startup.mark("配置");
+    auto first_frame = true;
 
     static ImVec4 clear_color = ImVec4(0.45F, 0.55F, 0.60F, 1.00F);
     ImGuiIO&      io          = ImGui::GetIO();
@@ -115,28 +170,41 @@ auto MainWindow::main(int /*argc*/, char** /*argv*/) -> int {
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-        glfwPollEvents();
+        waitForFrame();
         if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0) {
-            constexpr auto k_ms = 10ULL;
-            std::this_thread::sleep_for(std::chrono::milliseconds(k_ms));
+            if (m_frame_loop_config.m_event_driven) {
+                glfwWaitEvents();
+            }
+            else {
+                constexpr auto k_ms = 10ULL;
+                std::this_thread::sleep_for(std::chrono::milliseconds(k_ms));
+            }
             continue;
         }
 
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
+        m_input_recorder.beginFrame();
         ImGui::NewFrame();
-
-        // show all windows
-        for (auto it = m_windows.begin(); it != m_windows.end();) {
-            if (it->second->m_open) {
-                it->second->paint();
-                it++;
+        m_input_recorder.afterNewFrame();
+        m_frame_arena.reset();
+        triggerReplayEvents();
+        dispatchPostedEvents();
+        prepareWindows();
+
+        // show all windows, 关闭窗口时最后一个窗口移到当前位置, 所以按下标遍历
+        for (size_t i = 0; i < m_windows.size();) {
+            auto& w = m_windows.values()[i];
+            if (w->m_open) {
+                paintWindow(*w);
+                i++;
             }
             else {
-                it = closeWindow(it);
+                closeWindow(w->handle());
             }
         }
+        checkMemory();
         paint();
 
         // Rendering
@@ -159,12 +227,24 @@ auto MainWindow::main(int /*argc*/, char** /*argv*/) -> int {
             glfwMakeContextCurrent(backup_current_context);
         }
 
-        for (auto& [_, w] : m_windows) {
+        for (auto& w : m_windows) {
             w->afterAllPaint();
         }
 
         glfwSwapBuffers(window);
+        m_input_recorder.endFrame();
+        if (first_frame) {
+            // 首帧包括可见窗口的 init
+            first_frame = false;
+            startup.mark("首帧");
+            spdlog::info("startup: {}", startup.summary());
+        }
+        paceFrame();
+    }
+    for (auto& w : m_windows) {
+        w->waitBackgroundInit();
     }
+    m_input_recorder.stop();
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -178,13 +258,331 @@ auto MainWindow::main(int /*argc*/, char** /*argv*/) -> int {
     return 0;
 }
 
+auto MainWindow::wakeUp() -> void {
+    m_wake_requested = true;
+    if (!m_headless) {
+        glfwPostEmptyEvent();
+    }
+}
+
+auto MainWindow::fontGlyphText() const -> std::string {
+    std::string text;
+    for (auto& [name, _] : m_components) {
+        text += name;
+    }
+    try {
+        text += readConfig().value("字体额外字符", std::string{});
+    } catch (std::exception& e) {
+        spdlog::warn("read font glyph config error: {}", e.what());
+    }
+    return text;
+}
+
+auto MainWindow::loadFrameLoopConfig() -> void {
+    auto  json   = readConfig();
+    auto& config = json["帧循环"];
+    if (!config.is_object()) {
+        config = Json::object();
+    }
+    m_frame_loop_config.m_event_driven = config.value("事件驱动", m_frame_loop_config.m_event_driven);
+    m_frame_loop_config.m_target_fps   = std::max(config.value("目标帧率", m_frame_loop_config.m_target_fps), 0);
+    m_frame_loop_config.m_vsync        = config.value("垂直同步", m_frame_loop_config.m_vsync);
+    config                             = Json::object({
+        {"事件驱动", m_frame_loop_config.m_event_driven},
+        {"目标帧率", m_frame_loop_config.m_target_fps},
+        {"垂直同步", m_frame_loop_config.m_vsync},
+    });
+    writeConfig(json);
+
+    glfwSwapInterval(m_frame_loop_config.m_vsync ? 1 : 0);
+    m_next_frame_time = std::chrono::steady_clock::now();
+}
+
+auto MainWindow::loadMemoryBudget() -> void {
+    auto  json   = readConfig();
+    auto& config = json["内存预算"];
+    if (!config.is_object()) {
+        config = Json::object();
+    }
+    m_memory_budget.m_window_mb = config.value("单个窗口 (MB)", m_memory_budget.m_window_mb);
+    m_memory_budget.m_total_mb  = config.value("总计 (MB)", m_memory_budget.m_total_mb);
+    config                      = Json::object({
+        {"单个窗口 (MB)", m_memory_budget.m_window_mb},
+        {"总计 (MB)", m_memory_budget.m_total_mb},
+    });
+    writeConfig(json);
+}
+
+auto MainWindow::checkMemory() -> void {
+    constexpr auto   k_interval = std::chrono::seconds(1);
+    constexpr size_t k_mb       = 1024 * 1024;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < m_next_memory_check) {
+        return;
+    }
+    m_next_memory_check = now + k_interval;
+
+    auto measure = [](const Window& w) {
+        MemoryUsage usage;
+        w.memoryUsage(usage);
+        return usage;
+    };
+    m_memory_usage.clear();
+    for (size_t i = 0; i < m_windows.size(); i++) {
+        const auto& w = m_windows.values()[i];
+        if (w->m_initialized && w->backgroundInitDone()) {
+            m_memory_usage.emplace_back(m_windows.handleAt(i), measure(*w));
+        }
+    }
+    // 从占用最多的窗口开始释放缓存
+    std::ranges::sort(m_memory_usage, std::greater{}, [](const auto& i) { return i.second.total(); });
+
+    auto   window_budget = m_memory_budget.m_window_mb * k_mb;
+    size_t total         = 0;
+    for (auto& [h, usage] : m_memory_usage) {
+        const auto& w = m_windows.at(h);
+        if (window_budget > 0 && usage.total() > window_budget && w->trimMemory() > 0) {
+            usage = measure(*w);
+        }
+        auto over = window_budget > 0 && usage.total() > window_budget;
+        if (over && !w->m_over_budget) {
+            spdlog::warn("window memory over budget: {}, {} > {}", w->m_name, formatReadableBytes(usage.total()), formatReadableBytes(window_budget));
+        }
+        w->m_over_budget  = over;
+        total            += usage.total();
+    }
+
+    auto total_budget = m_memory_budget.m_total_mb * k_mb;
+    if (total_budget > 0 && total > total_budget) {
+        for (auto& [h, usage] : m_memory_usage) {
+            if (total <= total_budget) {
+                break;
+            }
+            const auto& w = m_windows.at(h);
+            if (w->trimMemory() > 0) {
+                total -= usage.total();
+                usage  = measure(*w);
+                total += usage.total();
+            }
+        }
+    }
+    auto over = total_budget > 0 && total > total_budget;
+    if (over && !m_over_total_budget) {
+        spdlog::warn("memory over budget: {} > {}", formatReadableBytes(total), formatReadableBytes(total_budget));
+    }
+    m_over_total_budget = over;
+}
+
+auto MainWindow::paintMemoryPanel() -> void {
+    size_t total = 0;
+    for (const auto& [_, usage] : m_memory_usage) {
+        total += usage.total();
+    }
+    ImGui::TextUnformatted(m_frame_arena.format("总计 {}, 预算 {} MB", formatReadableBytes(total), m_memory_budget.m_total_mb).data());
+    constexpr auto k_padding = 20.F;
+    for (const auto& [h, usage] : m_memory_usage) {
+        const auto* w = m_windows.get(h);
+        if (w == nullptr) {
+            continue;
+        }
+        ImGui::TextUnformatted(m_frame_arena.format("{}: {}", (*w)->m_name, formatReadableBytes(usage.total())).data());
+        ImGui::Indent(k_padding);
+        for (const auto& i : usage.m_items) {
+            ImGui::TextUnformatted(m_frame_arena.format("{} {}", i.m_category, formatReadableBytes(i.m_bytes)).data());
+        }
+        ImGui::Unindent(k_padding);
+    }
+}
+
+auto MainWindow::nextRedrawDeadline() const -> std::optional<std::chrono::steady_clock::time_point> {
+    auto deadline = m_redraw_deadline;
+    for (auto& w : m_windows) {
+        if (w->m_redraw_deadline && (!deadline || *w->m_redraw_deadline < *deadline)) {
+            deadline = w->m_redraw_deadline;
+        }
+    }
+    return deadline;
+}
+
+auto MainWindow::needsFrame() -> bool {
+    if (m_pending_frames > 0 || m_redraw || m_animating || m_input_recorder.isReplaying() || m_wake_requested.exchange(false)) {
+        return true;
+    }
+    for (auto& w : m_windows) {
+        if (w->m_redraw || w->m_animating || !w->m_open) {
+            return true;
+        }
+    }
+    auto deadline = nextRedrawDeadline();
+    return deadline && *deadline <= std::chrono::steady_clock::now();
+}
+
+auto MainWindow::waitForFrame() -> void {
+    // ImGui 处理一次输入通常需要多绘制几帧 (悬停, 输入拆分到多帧等)
+    constexpr auto k_frames_after_input = 3;
+
+    glfwPollEvents();
+    if (m_frame_loop_config.m_event_driven) {
+        while (ImGui::GetCurrentContext()->InputEventsQueue.Size == 0 && !needsFrame()) {
+            if (auto deadline = nextRedrawDeadline(); deadline) {
+                std::chrono::duration<double> timeout = *deadline - std::chrono::steady_clock::now();
+                glfwWaitEventsTimeout(std::max(timeout.count(), 0.));
+            }
+            else {
+                glfwWaitEvents();
+            }
+        }
+    }
+    if (ImGui::GetCurrentContext()->InputEventsQueue.Size > 0) {
+        m_pending_frames = k_frames_after_input;
+    }
+    else if (m_pending_frames > 0) {
+        m_pending_frames--;
+    }
+
+    // 清除已经到期的定时重绘
+    auto now = std::chrono::steady_clock::now();
+    if (m_redraw_deadline && *m_redraw_deadline <= now) {
+        m_redraw_deadline.reset();
+    }
+    for (auto& w : m_windows) {
+        if (w->m_redraw_deadline && *w->m_redraw_deadline <= now) {
+            w->m_redraw_deadline.reset();
+        }
+    }
+    m_redraw = false;
+
+    // 文本输入时光标需要闪烁
+    if (ImGui::GetIO().WantTextInput) {
+        constexpr auto k_cursor_blink = std::chrono::milliseconds(500);
+        requestRedrawAfter(k_cursor_blink);
+    }
+}
+
+auto MainWindow::paceFrame() -> void {
+    if (m_frame_loop_config.m_target_fps <= 0) {
+        return;
+    }
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1. / m_frame_loop_config.m_target_fps));
+    auto now    = std::chrono::steady_clock::now();
+    // 空闲等待之后或者落后太多时重新对齐, 不补帧
+    if (m_next_frame_time + period < now) {
+        m_next_frame_time = now;
+        return;
+    }
+    m_next_frame_time += period;
+    std::this_thread::sleep_until(m_next_frame_time);
+}
+
+auto MainWindow::startInputRecorder(const InputRecordOptions& options) -> void {
+    if (options.m_record_file) {
+        m_input_recorder.startRecording(*options.m_record_file);
+    }
+    if (options.m_replay_file) {
+        m_input_recorder.startReplay(*options.m_replay_file, options.m_realtime);
+    }
+}
+
+auto MainWindow::triggerReplayEvents() -> void {
+    for (auto& e : m_input_recorder.replayEvents()) {
+        auto h = findWindow(e.m_window_name);
+        if (!h) {
+            TG_LOG_DEDUP(spdlog::level::warn, "replay event window not found: {}, {}", e.m_window_name, e.m_event_name);
+            continue;
+        }
+        const auto& w = getWindow(h);
+        w->ensureReady();
+        w->callEvent(e.m_event_name);
+    }
+}
+
+auto MainWindow::dispatchPostedEvents() -> void {
+    m_posted_batch.clear();
+    while (auto e = m_posted_events.pop()) {
+        m_posted_batch.push_back(std::move(*e));
+    }
+    if (m_posted_batch.empty()) {
+        return;
+    }
+
+    // 从后向前标记重复的事件, 保留最后一个
+    struct Key {
+        uint64_t         m_window;
+        std::string_view m_event_name;
+
+        auto operator==(const Key&) const -> bool = default;
+    };
+    struct KeyHash {
+        auto operator()(const Key& k) const {
+            return std::hash<std::string_view>{}(k.m_event_name) ^ (k.m_window * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+    std::pmr::unordered_set<Key, KeyHash> seen(m_posted_batch.size(), &m_frame_arena);
+    std::pmr::vector<bool>                duplicate(m_posted_batch.size(), false, &m_frame_arena);
+    for (auto i = m_posted_batch.size(); i-- > 0;) {
+        duplicate[i] = !seen.insert({m_posted_batch[i].m_window.value(), m_posted_batch[i].m_event_name}).second;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    m_posted_event_stats.m_max_latency = {};
+    for (size_t i = 0; i < m_posted_batch.size(); i++) {
+        auto& e = m_posted_batch[i];
+        if (duplicate[i]) {
+            m_posted_event_stats.m_coalesced++;
+            continue;
+        }
+        m_posted_event_stats.m_max_latency = std::max(m_posted_event_stats.m_max_latency, std::chrono::duration_cast<std::chrono::nanoseconds>(now - e.m_time));
+        auto* w = m_windows.get(e.m_window);
+        if (w == nullptr) {
+            m_posted_event_stats.m_dropped++;
+            continue;
+        }
+        (*w)->ensureReady();
+        (*w)->callEvent(e.m_event_name, std::move(e.m_data));
+        m_posted_event_stats.m_delivered++;
+    }
+    // 事件数据可能持有较大的对象, 不留到下一帧
+    m_posted_batch.clear();
+}
+
+auto MainWindow::prepareWindows() -> void {
+    m_prepare_windows.clear();
+    for (auto& w : m_windows) {
+        if (w->m_open && w->m_initialized && w->backgroundInitDone() && w->m_init_error.empty()) {
+            m_prepare_windows.push_back(w.get());
+        }
+    }
+    // 每个窗口一个任务, prepare 中可以再调用 parallelFor
+    parallelFor(0, m_prepare_windows.size(), 1, [this](size_t b, size_t e) {
+        for (auto i = b; i < e; i++) {
+            m_prepare_windows[i]->runPrepare();
+        }
+    });
+}
+
+auto MainWindow::paintWindow(Window& w) -> void {
+    auto start = std::chrono::steady_clock::now();
+    w.m_redraw = false;
+    // 不推迟初始化的窗口在第一次绘制之前初始化
+    if (!w.m_lazy_init) {
+        w.tryInit();
+    }
+    if (w.m_lazy_init || w.m_init_error.empty()) {
+        w.paint();
+    }
+    w.m_paint_time = std::chrono::steady_clock::now() - start;
+}
+
 auto MainWindow::paint() -> void {
+    m_input_recorder.beforeBeginWindow(m_name);
     ImGui::Begin("TinyGraphics");
+    m_input_recorder.afterBeginWindow(m_name);
     if (ImGui::CollapsingHeader("Components", ImGuiTreeNodeFlags_DefaultOpen)) {
         constexpr auto k_padding = 20.F;
         ImGui::Indent(k_padding);
         for (auto& [name, c] : m_components) {
-            if (ImGui::Selectable(std::format("{}##{}{}", name, "Components", name).c_str())) {
+            if (ImGui::Selectable(c.m_label.c_str())) {
                 createWindow(name);
             }
         }
@@ -193,14 +591,17 @@ auto MainWindow::paint() -> void {
     if (ImGui::CollapsingHeader("Running", ImGuiTreeNodeFlags_DefaultOpen)) {
         constexpr auto k_padding = 20.F;
         ImGui::Indent(k_padding);
-        for (auto& [name, c] : m_windows) {
-            if (ImGui::CollapsingHeader(std::format("{}##{}{}", name, "Running", name).c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (auto& c : m_windows) {
+            const auto& name = c->m_name;
+            if (ImGui::CollapsingHeader(c->m_header_label.c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
                 ImGui::Indent(k_padding);
-                if (ImGui::Selectable(std::format("关闭##{}{}关闭", "Running", name).c_str())) {
+                ImGui::TextUnformatted(m_frame_arena.format("prepare {}, paint {}", formatReadableDuration(c->m_prepare_time), formatReadableDuration(c->m_paint_time)).data());
+                if (ImGui::Selectable(c->m_close_label.c_str())) {
                     c->m_open = false;
                 }
                 for (auto& item : c->m_events.m_event) {
-                    if (ImGui::Selectable(std::format("{}##{}{}{}", item.m_event_name, "Running", name, item.m_event_name).c_str())) {
+                    if (ImGui::Selectable(item.m_label.c_str()) && m_input_recorder.recordEvent(name, item.m_event_name)) {
+                        c->ensureReady();
                         c->callEvent(item.m_event_name);
                     }
                 }
@@ -209,31 +610,82 @@ auto MainWindow::paint() -> void {
         }
         ImGui::Unindent(k_padding);
     }
+    if (ImGui::CollapsingHeader("内存")) {
+        paintMemoryPanel();
+    }
+    if (ImGui::CollapsingHeader("事件队列")) {
+        auto stats = postedEventStats();
+        ImGui::TextUnformatted(m_frame_arena.format("等待 {}, 已调用 {}, 合并 {}, 丢弃 {}", stats.m_depth, stats.m_delivered, stats.m_coalesced, stats.m_dropped).data());
+        ImGui::TextUnformatted(m_frame_arena.format("最大延迟 {}", formatReadableDuration(stats.m_max_latency)).data());
+    }
     ImGui::End();
 }
 
 auto Window::paint() -> void {
-    ImGui::Begin(m_name.c_str(), &m_open, ImGuiWindowFlags_HorizontalScrollbar);
+    auto& recorder = MainWindow::getInstance().inputRecorder();
+    recorder.beforeBeginWindow(m_name);
+    auto visible = ImGui::Begin(m_name.c_str(), &m_open, ImGuiWindowFlags_HorizontalScrollbar);
+    recorder.afterBeginWindow(m_name);
+
+    // 折叠或者停靠在未选中的标签页中时不可见, 第一次可见时才初始化
+    if (visible) {
+        tryInit();
+    }
 
+#ifdef _WIN32
     if (m_set_window_top || m_set_not_window_top) {
         auto* viewport = ImGui::GetWindowViewport();
-        auto* w        = static_cast<GLFWwindow*>(viewport->PlatformHandle);
-        if (!w) {
-            return;
-        }
-        auto* hwnd = glfwGetWin32Window(w);
-        if (!SetWindowPos(hwnd, m_set_window_top ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE)) {
-            spdlog::error("SetWindowPos error: {}", getSystemLastErrorAsString());
+        // 无界面模式或者窗口合并在主视口中时没有平台窗口
+        if (auto* w = static_cast<GLFWwindow*>(viewport->PlatformHandle); w) {
+            auto* hwnd = glfwGetWin32Window(w);
+            if (!SetWindowPos(hwnd, m_set_window_top ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE)) {
+                spdlog::error("SetWindowPos error: {}", getSystemLastErrorAsString());
+            }
+            m_set_window_top     = false;
+            m_set_not_window_top = false;
         }
-        m_set_window_top     = false;
-        m_set_not_window_top = false;
     }
+#endif
 
-    impl_paint();
+    auto ready = m_initialized && backgroundInitDone();
+    if (!m_init_error.empty()) {
+        ImGui::TextWrapped("初始化失败: %s", m_init_error.c_str());
+    }
+    else if (ready) {
+        impl_paint();
+    }
+    else if (m_initialized) {
+        ImGui::TextUnformatted("加载中...");
+    }
 
     ImGui::End();
 }
 
+auto Window::memoryUsage(MemoryUsage& usage) const -> void {
+    auto bytes = m_events.m_event.size() * sizeof(Events::EventItem);
+    for (const auto& e : m_events.m_event) {
+        bytes += e.m_event_name.capacity() + e.m_label.capacity();
+    }
+    usage.add("事件", bytes);
+}
+
+auto Window::postEvent(std::string_view event_name, std::any data) const -> void {
+    MainWindow::getInstance().postEvent(m_handle, event_name, std::move(data));
+}
+
+auto Window::initInBackground(std::function<void()> f) -> void {
+    m_background_init = std::async(std::launch::async, [f = std::move(f)]() {
+        // 失败时也需要唤醒主循环显示错误
+        try {
+            f();
+        } catch (...) {
+            MainWindow::getInstance().wakeUp();
+            throw;
+        }
+        MainWindow::getInstance().wakeUp();
+    });
+}
+
 auto Window::getClickedPoint() -> std::tuple<bool, Point2> {
     (void)this;
     if (ImGui::IsWindowHovered(ImGuiHoveredFlags_None) && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
@@ -1,22 +1,68 @@
 #pragma once
+#include <tg/FrameArena.h>
+#include <tg/MpscQueue.h>
 #include <tg/Point.h>
+#include <tg/SlotMap.h>
+#include <tg/log.h>
+#include <tg/ui/InputRecorder.h>
 #include <tg/utils.h>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <functional>
+#include <future>
+#include <optional>
 
 namespace tg::ui {
 class Component;
 class Window;
+class Event;
+class HeadlessOptions;
+
+using WindowHandle   = Handle<Window>;
+using EventHandle    = Handle<Event>;
+using FunctionHandle = Handle<std::function<std::any(const std::any&)>>;
+
+// 窗口占用的内存, 按类别 (画布, 纹理, 事件等) 统计字节数
+class MemoryUsage {
+public:
+    class Item {
+    public:
+        std::string m_category;
+        size_t      m_bytes = 0;
+    };
+
+    // 同一类别累加
+    auto add(std::string_view category, size_t bytes) -> void {
+        auto it = std::ranges::find(m_items, category, &Item::m_category);
+        if (it == m_items.end()) {
+            m_items.push_back({std::string{category}, bytes});
+        }
+        else {
+            it->m_bytes += bytes;
+        }
+    }
+
+    auto total() const {
+        size_t bytes = 0;
+        for (const auto& i : m_items) {
+            bytes += i.m_bytes;
+        }
+        return bytes;
+    }
+
+    std::vector<Item> m_items;
+};
 
 class Event {
 public:
     Event(Window* w, std::string_view event_name, std::any data = {})
         : m_window(w), m_event_name(event_name), m_data(std::move(data)) {}
 
-    Window*     m_window;
-    std::string m_event_name;
-    std::any    m_data;
+    Window*          m_window;
+    std::string_view m_event_name;   // 只在回调中有效
+    std::any         m_data;
 };
 
 class Window {
@@ -27,6 +73,7 @@ private:
         public:
             std::string                       m_event_name;
             std::function<void(const Event&)> m_callback;
+            std::string                       m_label;   // 事件列表中的 ImGui 标签
         };
 
         auto callEvent(const Event& e) const {
@@ -39,11 +86,11 @@ private:
                     }
                 }
                 if (item == nullptr) {
-                    throw std::runtime_error(std::format("event not found: {}, {}.", m_window->m_name, item->m_event_name));
+                    throw std::runtime_error(std::format("event not found: {}, {}.", m_window->m_name, e.m_event_name));
                 }
                 item->m_callback(e);
             } catch (std::exception& e) {
-                spdlog::error("callEvent error: {}", e.what());
+                TG_LOG_RATE_LIMITED(spdlog::level::err, 5, "callEvent error: {}", e.what());
             }
         }
 
@@ -51,18 +98,28 @@ private:
             callEvent(Event(m_window, event_name, std::move(data)));
         }
 
-        auto registerEvent(std::string_view event_name, std::function<void(const Event&)> callback) {
-            m_event.emplace_back(std::string{event_name}, std::move(callback));
+        // 通过句柄调用, 不需要按名字查找
+        auto callEvent(EventHandle handle, std::any data = {}) const {
+            try {
+                const auto& item = m_event.at(handle);
+                item.m_callback(Event(m_window, item.m_event_name, std::move(data)));
+            } catch (std::exception& e) {
+                TG_LOG_RATE_LIMITED(spdlog::level::err, 5, "callEvent error: {}", e.what());
+            }
+        }
+
+        auto registerEvent(std::string_view event_name, std::function<void(const Event&)> callback) -> EventHandle {
+            return m_event.emplace(std::string{event_name}, std::move(callback), std::format("{}##{}{}{}", event_name, "Running", m_window->m_name, event_name));
         }
 
-        auto registerEvent(std::string_view event_name, std::function<void()> callback) {
-            registerEvent(event_name, [callback = std::move(callback)](const Event&) {
+        auto registerEvent(std::string_view event_name, std::function<void()> callback) -> EventHandle {
+            return registerEvent(event_name, [callback = std::move(callback)](const Event&) {
                 callback();
             });
         }
 
-        Window*                m_window;
-        std::vector<EventItem> m_event;
+        Window*                   m_window;
+        SlotMap<EventItem, Event> m_event;
     };
 
 public:
@@ -76,8 +133,32 @@ public:
     auto operator=(const Window&) = delete;
     auto operator=(Window&&)      = delete;
 
+    // 在主线程第一次绘制 (或者第一次被调用事件) 之前调用, 而不是创建时. 耗时的初始化放到 initInBackground 中
     virtual auto init() -> void {}
 
+    // 返回 true 时推迟到窗口第一次可见时才调用 init, 折叠或者停靠在未选中的标签页中的窗口不占用启动时间.
+    // 由 Window::paint 判断可见性, 重写了 paint 的窗口不能返回 true
+    virtual auto lazyInit() const -> bool {
+        return false;
+    }
+
+    auto handle() const {
+        return m_handle;
+    }
+
+    // 保存当前画面到文件 (不含扩展名), 没有画面的窗口返回 false
+    virtual auto saveSnapshot(const std::filesystem::path& /*path*/) const -> bool {
+        return false;
+    }
+
+    // 统计占用的内存, 重写时需要调用父类. 在主线程调用, 只在初始化 (包括后台初始化) 完成后调用
+    virtual auto memoryUsage(MemoryUsage& usage) const -> void;
+
+    // 超出内存预算时调用, 释放可以重新生成的缓存 (临时缓冲等), 返回释放的字节数. 重写时需要调用父类
+    virtual auto trimMemory() -> size_t {
+        return 0;
+    }
+
 protected:
     virtual auto paint() -> void;
     virtual auto afterAllPaint() -> void {}
@@ -86,10 +167,21 @@ protected:
         m_events.callEvent(event_name, std::move(data));
     }
 
-    auto registerEvent(std::string_view event_name, std::function<void()> callback) {
-        m_events.registerEvent(event_name, std::move(callback));
+    auto callEvent(EventHandle handle, std::any data = {}) const {
+        m_events.callEvent(handle, std::move(data));
+    }
+
+    // 可在任意线程调用, 不阻塞, 事件在下一帧绘制之前在主线程调用. 用于后台计算完成后通知窗口
+    auto postEvent(std::string_view event_name, std::any data = {}) const -> void;
+
+    auto registerEvent(std::string_view event_name, std::function<void()> callback) -> EventHandle {
+        return m_events.registerEvent(event_name, std::move(callback));
     }
 
+    // 在 init 中调用: f 在后台线程执行 (不能调用 ImGui), 完成之前窗口只显示加载提示, 不调用 impl_paint,
+    // 事件会等待 f 完成后再调用
+    auto initInBackground(std::function<void()> f) -> void;
+
     template <typename ValueType>
     auto readConfig(std::string_view name, ValueType& v) const {
         auto j = readConfig();
@@ -110,6 +202,10 @@ protected:
 
     virtual auto impl_paint() -> void {}
 
+    // 每帧在 paint 之前调用, 所有窗口的 prepare 在线程池中并行执行. 用于光栅化等耗时的计算, 不能调用 ImGui,
+    // 只能访问本窗口的数据. 只在初始化 (包括后台初始化) 完成后调用. 不重写时所有工作都在 impl_paint 中完成
+    virtual auto prepare() -> void {}
+
     auto getConfigFilePath() const -> std::filesystem::path {
         return std::filesystem::current_path() / "config" / std::format("{}.json", m_component_name);
     }
@@ -138,22 +234,112 @@ protected:
     auto setWindowTop(bool topmost) {
         m_set_window_top     = topmost;
         m_set_not_window_top = !topmost;
+        requestRedraw();
+    }
+
+    // 请求在下一帧重绘, 事件驱动模式下没有输入时不会主动绘制
+    auto requestRedraw() -> void {
+        m_redraw = true;
+    }
+
+    // 请求在指定时间点重绘, 多次请求取最早的时间点
+    auto requestRedrawAt(std::chrono::steady_clock::time_point deadline) -> void {
+        if (!m_redraw_deadline || deadline < *m_redraw_deadline) {
+            m_redraw_deadline = deadline;
+        }
+    }
+
+    auto requestRedrawAfter(std::chrono::nanoseconds delay) -> void {
+        requestRedrawAt(std::chrono::steady_clock::now() + delay);
+    }
+
+    // 持续动画, 开启后每帧都会绘制 (仍受目标帧率限制)
+    auto setAnimating(bool animating) -> void {
+        m_animating = animating;
     }
 
     std::string m_name;
 
 private:
-    std::string m_component_name;
-    bool        m_open;
-    Events      m_events{.m_window = this};
-    bool        m_set_window_top     = false;
-    bool        m_set_not_window_top = false;
+    auto ensureInit() -> void {
+        if (!m_initialized) {
+            m_initialized = true;
+            init();
+        }
+    }
+
+    // 绘制时初始化, 异常记录到 m_init_error, 不传出 (ImGui 窗口还没有 End)
+    auto tryInit() -> void {
+        try {
+            ensureInit();
+        } catch (std::exception& e) {
+            m_init_error = e.what();
+            spdlog::error("init error: {}, {}", m_name, e.what());
+        }
+    }
+
+    // 后台初始化已经完成 (或者没有) 时返回 true, 不阻塞
+    auto backgroundInitDone() -> bool {
+        if (m_background_init.valid() && m_background_init.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+        waitBackgroundInit();
+        return true;
+    }
+
+    auto waitBackgroundInit() -> void {
+        if (!m_background_init.valid()) {
+            return;
+        }
+        try {
+            m_background_init.get();
+        } catch (std::exception& e) {
+            m_init_error = e.what();
+            spdlog::error("background init error: {}, {}", m_name, e.what());
+        }
+    }
+
+    // 调用事件之前需要完成初始化
+    auto ensureReady() -> void {
+        ensureInit();
+        waitBackgroundInit();
+    }
+
+    // 在工作线程中调用
+    auto runPrepare() -> void {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            prepare();
+        } catch (std::exception& e) {
+            TG_LOG_RATE_LIMITED(spdlog::level::err, 5, "prepare error: {}, {}", m_name, e.what());
+        }
+        m_prepare_time = std::chrono::steady_clock::now() - start;
+    }
+
+    WindowHandle                                         m_handle;
+    std::string                                          m_component_name;
+    bool                                                 m_open;
+    Events                                               m_events{.m_window = this};
+    bool                                                 m_set_window_top     = false;
+    bool                                                 m_set_not_window_top = false;
+    bool                                                 m_redraw             = true;
+    bool                                                 m_animating          = false;
+    std::optional<std::chrono::steady_clock::time_point> m_redraw_deadline;
+    bool                                                 m_initialized        = false;
+    bool                                                 m_lazy_init          = false;   // lazyInit() 的结果, 创建窗口时确定
+    std::future<void>                                    m_background_init;
+    std::string                                          m_init_error;
+    std::chrono::nanoseconds                             m_prepare_time{};   // 上一帧的耗时
+    std::chrono::nanoseconds                             m_paint_time{};
+    std::string                                          m_header_label;   // Running 列表中的 ImGui 标签, 创建时生成
+    std::string                                          m_close_label;
+    bool                                                 m_over_budget        = false;   // 只在超出预算时提示一次
 };
 
 class Component {
 public:
     Component(std::string_view name, std::function<std::unique_ptr<Window>()> create)
-        : m_name(name), m_create(std::move(create)) {}
+        : m_name(name), m_create(std::move(create)), m_label(std::format("{}##{}{}", name, "Components", name)) {}
 
     ~Component()                     = default;
 
@@ -164,13 +350,56 @@ public:
 
     std::string                              m_name;
     std::function<std::unique_ptr<Window>()> m_create;
+    std::string                              m_label;   // 组件列表中的 ImGui 标签
 };
 
 class MainWindow final : public Window {
 public:
+    // 帧循环配置, 保存在配置文件的 "帧循环" 项中
+    class FrameLoopConfig {
+    public:
+        bool m_event_driven = true;   // 没有输入和重绘请求时阻塞等待事件
+        int  m_target_fps   = 60;     // 0 表示不限制
+        bool m_vsync        = true;
+    };
+
+    // 内存预算, 保存在配置文件的 "内存预算" 项中, 0 表示不限制
+    class MemoryBudget {
+    public:
+        size_t m_window_mb = 1024;   // 单个窗口
+        size_t m_total_mb  = 4096;   // 所有窗口
+    };
+
+    // 跨线程投递事件的统计
+    class PostedEventStats {
+    public:
+        size_t                   m_depth     = 0;   // 还没有处理的事件数
+        uint64_t                 m_delivered = 0;
+        uint64_t                 m_coalesced = 0;   // 同一帧中被合并的重复事件
+        uint64_t                 m_dropped   = 0;   // 窗口已经关闭
+        std::chrono::nanoseconds m_max_latency{};   // 最近一批事件从投递到调用的最大延迟
+    };
+
     auto main(int argc, char** argv) -> int;
     auto paint() -> void override;
 
+    // 唤醒主循环并绘制一帧, 可在任意线程调用
+    auto wakeUp() -> void;
+
+    // 无界面模式: 没有 OpenGL 上下文, ImGui 只做布局不做渲染
+    auto isHeadless() const {
+        return m_headless;
+    }
+
+    auto inputRecorder() -> InputRecorder& {
+        return m_input_recorder;
+    }
+
+    // 每帧开始时重置, 只能在主线程的 paint 中使用
+    auto frameArena() -> FrameArena& {
+        return m_frame_arena;
+    }
+
     static auto getInstance() -> MainWindow& {
         static MainWindow instance;
         return instance;
@@ -191,56 +420,107 @@ public:
         return it->second;
     }
 
-    auto createWindow(std::string_view component_name) {
-        size_t      n = 2;
-        std::string window_name(component_name);
-        while (true) {
-            auto [it, ok] = m_windows.emplace(window_name, nullptr);
-            if (ok) {
-                it->second = makeWindow(component_name, window_name);
-                saveWindowsConfig();
-                return;
-            }
-            window_name = std::format("{}-{}", component_name, n++);
-        }
+    auto createWindow(std::string_view component_name) -> WindowHandle {
+        auto h = addWindow(component_name, uniqueWindowName(component_name));
+        saveWindowsConfig();
+        return h;
     }
 
-    auto closeWindow(std::string_view window_name) {
-        auto it = m_windows.erase(window_name);
-        saveWindowsConfig();
-        return it;
+    // 窗口不存在时返回 false
+    auto closeWindow(std::string_view window_name) -> bool {
+        auto h = findWindow(window_name);
+        return h && closeWindow(h);
     }
 
-    auto closeWindow(unordered_map_string<std::unique_ptr<Window>>::iterator it) {
-        auto res = m_windows.erase(it);
+    // 删除后最后一个窗口移到被删除的位置, 遍历 m_windows 时需要注意
+    auto closeWindow(WindowHandle handle) -> bool {
+        auto* w = m_windows.get(handle);
+        if (w == nullptr) {
+            return false;
+        }
+        (*w)->waitBackgroundInit();
+        m_window_names.erase((*w)->m_name);
+        m_windows.erase(handle);
         saveWindowsConfig();
-        return res;
+        return true;
+    }
+
+    // 窗口不存在时返回空句柄
+    auto findWindow(std::string_view window_name) const -> WindowHandle {
+        auto it = m_window_names.find(window_name);
+        return it == m_window_names.end() ? WindowHandle{} : it->second;
     }
 
     auto getWindow(std::string_view window_name) const -> const std::unique_ptr<Window>& {
-        auto it = m_windows.find(window_name);
-        if (it == m_windows.end()) {
-            throw tg_exception();
+        auto h = findWindow(window_name);
+        if (!h) {
+            throw tg_exception("window not found: {}", window_name);
         }
-        return it->second;
+        return m_windows.at(h);
+    }
+
+    // 窗口已关闭时抛出异常
+    auto getWindow(WindowHandle handle) const -> const std::unique_ptr<Window>& {
+        return m_windows.at(handle);
     }
 
+    // 窗口还没有初始化时先初始化
     auto callEvent(std::string_view window_name, std::string_view event_name, std::any data = {}) {
-        auto& w = const_cast<std::unique_ptr<Window>&>(getWindow(window_name));
+        const auto& w = getWindow(window_name);
+        w->ensureReady();
+        w->callEvent(event_name, std::move(data));
+    }
+
+    auto callEvent(WindowHandle window, std::string_view event_name, std::any data = {}) {
+        const auto& w = getWindow(window);
+        w->ensureReady();
         w->callEvent(event_name, std::move(data));
     }
 
-    auto registerFunction(std::string_view name, std::function<std::any(const std::any&)> callback) {
-        m_functions.try_emplace(std::string{name}, std::function<std::any(const std::any&)>{}).first->second = std::move(callback);
+    // 可在任意线程调用, 不阻塞. 事件在下一帧绘制之前在主线程调用, 同一帧中同一窗口的同名事件只调用一次 (使用最后的数据),
+    // 窗口已经关闭时丢弃
+    auto postEvent(WindowHandle window, std::string_view event_name, std::any data = {}) -> void {
+        m_posted_events.push({window, std::string{event_name}, std::move(data), std::chrono::steady_clock::now()});
+        wakeUp();
+    }
+
+    auto postedEventStats() const -> PostedEventStats {
+        auto stats    = m_posted_event_stats;
+        stats.m_depth = m_posted_events.size();
+        return stats;
+    }
+
+    // 同名函数已经存在时替换回调, 句柄不变
+    auto registerFunction(std::string_view name, std::function<std::any(const std::any&)> callback) -> FunctionHandle {
+        if (auto it = m_function_names.find(name); it != m_function_names.end()) {
+            m_functions.at(it->second) = std::move(callback);
+            return it->second;
+        }
+        auto h = m_functions.insert(std::move(callback));
+        m_function_names.emplace(std::string{name}, h);
+        return h;
+    }
+
+    auto findFunction(std::string_view name) const -> FunctionHandle {
+        auto it = m_function_names.find(name);
+        return it == m_function_names.end() ? FunctionHandle{} : it->second;
     }
 
     auto callFunction(std::string_view name, const std::any& any) {
-        auto it = m_functions.find(name);
-        if (it == m_functions.end()) {
+        auto h = findFunction(name);
+        if (!h) {
             throw tg_exception("callFunction not found: {}", name);
         }
+        return callFunction(h, any);
+    }
+
+    auto callFunction(FunctionHandle handle, const std::any& any) -> std::any {
+        const auto* f = m_functions.get(handle);
+        if (f == nullptr) {
+            throw tg_exception("callFunction invalid handle: {}", handle.value());
+        }
         try {
-            return it->second(any);
+            return (*f)(any);
         } catch (std::exception& e) {
             throw tg_exception("callFunction exception: {}", e.what());
         }
@@ -249,22 +529,60 @@ public:
 private:
     MainWindow() = default;
 
+    auto loadFrameLoopConfig() -> void;
+    auto waitForFrame() -> void;
+    auto needsFrame() -> bool;
+    auto nextRedrawDeadline() const -> std::optional<std::chrono::steady_clock::time_point>;
+    auto paceFrame() -> void;
+    auto runHeadless(const HeadlessOptions& options) -> int;
+    auto startInputRecorder(const InputRecordOptions& options) -> void;
+    auto triggerReplayEvents() -> void;
+    auto dispatchPostedEvents() -> void;
+    auto loadMemoryBudget() -> void;
+    auto checkMemory() -> void;
+    auto paintMemoryPanel() -> void;
+    auto prepareWindows() -> void;
+    auto paintWindow(Window& w) -> void;
+    auto fontGlyphText() const -> std::string;
+
+    // 同一组件的第二个窗口起名字后面加序号
+    auto uniqueWindowName(std::string_view component_name) const -> std::string {
+        size_t      n = 2;
+        std::string window_name(component_name);
+        while (m_window_names.contains(window_name)) {
+            window_name = std::format("{}-{}", component_name, n++);
+        }
+        return window_name;
+    }
+
+    auto addWindow(std::string_view component_name, std::string_view window_name) -> WindowHandle {
+        if (m_window_names.contains(window_name)) {
+            throw tg_exception("window exists: {}", window_name);
+        }
+        auto h                    = m_windows.insert(makeWindow(component_name, window_name));
+        m_windows.at(h)->m_handle = h;
+        m_window_names.emplace(std::string{window_name}, h);
+        return h;
+    }
+
     auto makeWindow(std::string_view component_name, std::string_view window_name) const -> std::unique_ptr<Window> {
         auto& c             = getComponent(component_name);
         auto  w             = c.m_create();
         w->m_component_name = component_name;
         w->m_name           = window_name;
         w->m_open           = true;
-        w->init();
+        w->m_lazy_init      = w->lazyInit();
+        w->m_header_label   = std::format("{}##{}{}", window_name, "Running", window_name);
+        w->m_close_label    = std::format("关闭##{}{}关闭", "Running", window_name);
         return w;
     }
 
     auto saveWindowsConfig() -> void {
         std::vector<Json> ws;
-        for (auto& i : m_windows) {
+        for (auto& w : m_windows) {
             ws.push_back(Json::object({
-                {"component name", i.second->m_component_name},
-                {"window name", i.second->m_name},
+                {"component name", w->m_component_name},
+                {"window name", w->m_name},
             }));
         }
         writeConfig("启动的窗口", ws);
@@ -282,16 +600,40 @@ private:
         for (auto& i : ws) {
             auto& component_name = i["component name"].get_ref<const std::string&>();
             auto& window_name    = i["window name"].get_ref<const std::string&>();
-            if (!m_windows.emplace(window_name, makeWindow(component_name, window_name)).second) {
-                throw tg_exception();
-            }
+            addWindow(component_name, window_name);
         }
         writeConfig("启动的窗口", ws);
     }
 
     unordered_map_string<Component>                                m_components;
-    unordered_map_string<std::unique_ptr<Window>>                  m_windows;
-    unordered_map_string<std::function<std::any(const std::any&)>> m_functions;
+    SlotMap<std::unique_ptr<Window>, Window>                       m_windows;
+    unordered_map_string<WindowHandle>                             m_window_names;   // 窗口名到句柄的索引
+    SlotMap<std::function<std::any(const std::any&)>>              m_functions;
+    unordered_map_string<FunctionHandle>                           m_function_names;
+    std::vector<Window*>                                           m_prepare_windows;   // 每帧复用
+
+    FrameLoopConfig                                                m_frame_loop_config;
+    MemoryBudget                                                   m_memory_budget;
+    std::vector<std::pair<WindowHandle, MemoryUsage>>              m_memory_usage;   // 最近一次 checkMemory 的结果
+    std::chrono::steady_clock::time_point                          m_next_memory_check;
+    bool                                                           m_over_total_budget = false;
+    int                                                            m_pending_frames = 0;   // 输入之后 ImGui 还需要几帧才能稳定
+    std::atomic<bool>                                              m_wake_requested = false;
+    std::chrono::steady_clock::time_point                          m_next_frame_time;
+    bool                                                           m_headless = false;
+    InputRecorder                                                  m_input_recorder;
+    FrameArena                                                     m_frame_arena;
+
+    struct PostedEvent {
+        WindowHandle                          m_window;
+        std::string                           m_event_name;
+        std::any                              m_data;
+        std::chrono::steady_clock::time_point m_time;
+    };
+
+    MpscQueue<PostedEvent>                                         m_posted_events;
+    std::vector<PostedEvent>                                       m_posted_batch;   // 每帧复用
+    PostedEventStats                                               m_posted_event_stats;
 };
 
 inline auto registerComponent(std::string_view name, const std::function<std::unique_ptr<Window>()>& create) {
@@ -304,7 +646,12 @@ inline auto registerComponent(std::string_view name) {
 }
 
 inline auto registerFunction(std::string_view name, std::function<std::any(const std::any&)> callback) {
-    MainWindow::getInstance().registerFunction(name, std::move(callback));
+    return MainWindow::getInstance().registerFunction(name, std::move(callback));
+}
+
+// 频繁调用时先用 MainWindow::findFunction 取得句柄, 省去每次按名字查找
+inline auto callFunction(FunctionHandle handle, const std::any& any) {
+    return MainWindow::getInstance().callFunction(handle, any);
 }
 
 template <bool StatisticTime = true>
@@ -316,7 +663,7 @@ inline auto callFunction(std::string_view name, const std::any& any) {
     auto res   = MainWindow::getInstance().callFunction(name, any);
     auto end   = std::chrono::high_resolution_clock::now();
     auto diff  = end - start;
-    spdlog::info("funtion used time: {}, {}", name, formatReadableDuration(diff));
+    TG_LOG_RATE_LIMITED(spdlog::level::info, 10, "funtion used time: {}, {}", name, formatReadableDuration(diff));
     return res;
 }
 }   // namespace tg::ui
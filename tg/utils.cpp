@@ -1,6 +1,12 @@
 #include <tg/utils.h>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#endif
+
 namespace tg {
+#ifdef _WIN32
 namespace {
 auto localToUtf8(const std::string& localStr) -> std::string {
     auto wideCharSize = MultiByteToWideChar(CP_ACP, 0, localStr.c_str(), -1, nullptr, 0);
@@ -33,4 +39,13 @@ auto getSystemLastErrorAsString() -> std::string {
     LocalFree(messageBuffer);
     return std::format("({}) {}", errorMessageID, message);
 }
+#else
+auto getSystemLastErrorAsString() -> std::string {
+    auto errorMessageID = errno;
+    if (errorMessageID == 0) {
+        return "(0) No error";
+    }
+    return std::format("({}) {}", errorMessageID, std::strerror(errorMessageID));
+}
+#endif
 }   // namespace tg
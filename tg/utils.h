@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <numbers>
@@ -104,6 +105,22 @@ inline constexpr auto formatReadableDuration(std::chrono::nanoseconds duration)
     return std::format("{}.{:06} ms", ms.count(), us.count());
 }
 
+inline auto formatReadableBytes(size_t bytes) {
+    constexpr size_t k_kb = 1024;
+    constexpr size_t k_mb = k_kb * 1024;
+    constexpr size_t k_gb = k_mb * 1024;
+    if (bytes >= k_gb) {
+        return std::format("{:.2f} GB", static_cast<double>(bytes) / k_gb);
+    }
+    if (bytes >= k_mb) {
+        return std::format("{:.2f} MB", static_cast<double>(bytes) / k_mb);
+    }
+    if (bytes >= k_kb) {
+        return std::format("{:.2f} KB", static_cast<double>(bytes) / k_kb);
+    }
+    return std::format("{} B", bytes);
+}
+
 inline auto currentFilenameWithoutCpp(const std::source_location& source_location = std::source_location::current()) {
     constexpr std::string_view k_suffix = ".cpp";
     auto                       name     = std::string_view{source_location.file_name()};
@@ -122,9 +139,10 @@ inline auto currentFilenameWithoutCpp(const std::source_location& source_locatio
     return std::string{name};
 }
 
+// 进程内唯一的 ID, 可在任意线程调用
 inline auto getNextID() {
-    static auto id = 1ULL;
-    return id++;
+    static std::atomic<uint64_t> id = 1;
+    return id.fetch_add(1, std::memory_order_relaxed);
 }
 
 auto getSystemLastErrorAsString() -> std::string;
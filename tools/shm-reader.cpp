@@ -0,0 +1,108 @@
+#include <tg/shm/FrameRing.h>
+
+#include <thread>
+
+/*
+共享内存帧读取程序, 用于测试 FixedCanvas2D 的共享内存发布
+
+shm-reader 名字 [帧数]     读取其它进程发布的帧, 打印帧序号, 大小和延迟
+shm-reader --self-test     在本进程中同时写入和读取, 检查读到的帧没有被撕裂
+*/
+
+using namespace tg;
+
+namespace {
+auto nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+auto read(std::string_view name, uint64_t frames) -> int {
+    shm::FrameRingReader reader(name);
+    spdlog::info("opened: {}, {} slot(s)", name, reader.slotCount());
+
+    uint64_t received = 0;
+    uint64_t torn     = 0;
+    while (received < frames) {
+        auto view = reader.acquireLatest();
+        if (!view) {
+            std::this_thread::yield();
+            continue;
+        }
+        // 直接在共享内存上计算, 没有拷贝
+        uint64_t checksum = 0;
+        for (auto b : view->m_data) {
+            checksum += static_cast<uint8_t>(b);
+        }
+        auto latency = nowNs() - view->m_timestamp_ns;
+        if (!view->valid()) {
+            torn++;
+            continue;
+        }
+        received++;
+        spdlog::info("frame {}: {}x{}, {} bytes, checksum {}, latency {}", view->m_frame, view->m_width, view->m_height, view->m_data.size(), checksum, formatReadableDuration(std::chrono::nanoseconds(latency)));
+    }
+    spdlog::info("received {} frame(s), {} overwritten while reading", received, torn);
+    return 0;
+}
+
+auto selfTest() -> int {
+    constexpr auto k_width  = 256U;
+    constexpr auto k_height = 256U;
+    constexpr auto k_frames = 20000ULL;
+    constexpr auto k_name   = "tg-shm-reader-self-test";
+
+    shm::FrameRingWriter writer(k_name, static_cast<uint64_t>(k_width) * k_height * 3);
+    shm::FrameRingReader reader(k_name);
+
+    std::atomic<bool> done = false;
+    std::thread       producer([&]() {
+        std::vector<uint8_t> image(static_cast<size_t>(k_width) * k_height * 3);
+        for (auto i = 1ULL; i <= k_frames; i++) {
+            std::ranges::fill(image, static_cast<uint8_t>(i));
+            writer.publish(image.data(), k_width, k_height, k_width * 3, k_width * 3, shm::FrameFormat::BGR8);
+        }
+        done = true;
+    });
+
+    uint64_t received = 0;
+    uint64_t torn     = 0;
+    uint64_t errors   = 0;
+    while (!done || reader.latest() != k_frames) {
+        auto view = reader.acquireLatest();
+        if (!view) {
+            continue;
+        }
+        auto expected = static_cast<std::byte>(view->m_frame);
+        auto ok       = std::ranges::all_of(view->m_data, [&](auto b) { return b == expected; });
+        if (!view->valid()) {
+            torn++;
+            continue;
+        }
+        received++;
+        if (!ok || view->m_width != k_width || view->m_height != k_height) {
+            errors++;
+        }
+    }
+    producer.join();
+
+    spdlog::info("self test: {} written, {} received, {} overwritten while reading, {} error(s)", k_frames, received, torn, errors);
+    return errors == 0 && received > 0 ? 0 : 1;
+}
+}   // namespace
+
+auto main(int argc, char** argv) -> int {
+    try {
+        if (argc >= 2 && std::string_view{argv[1]} == "--self-test") {
+            return selfTest();
+        }
+        if (argc < 2) {
+            spdlog::error("usage: shm-reader 名字 [帧数] | shm-reader --self-test");
+            return 1;
+        }
+        auto frames = argc >= 3 ? std::stoull(argv[2]) : std::numeric_limits<uint64_t>::max();
+        return read(argv[1], frames);
+    } catch (std::exception& e) {
+        spdlog::error("shm-reader error: {}", e.what());
+        return 1;
+    }
+}
@@ -8,7 +8,7 @@ add_cxflags("cl::/wd4244") -- 隐式类型转换可能丢失数据的警告
 
 add_includedirs(".")
 add_includedirs("thirdParty")
-add_includedirs("thirdParty/GLFW/include")
+add_includedirs("thirdParty/glfw/include")
 add_includedirs("thirdParty/imgui")
 add_includedirs("thirdParty/opencv/include")
 
@@ -17,12 +17,30 @@ target("TinyGraphics")
     add_files("tg/**.cpp")
     add_files("example/**.cpp")
 
-	add_links("opengl32")
-	add_links("gdi32")
-    add_defines("_GLFW_WIN32=1")
     add_files("thirdParty/glfw/src/*.c")
-
     add_files("thirdParty/imgui/*.cpp")
 
-	add_linkdirs("thirdParty/opencv/x64/vc16/lib")
-	add_links("opencv_world4100")
+    if is_plat("windows") then
+        add_links("opengl32")
+        add_links("gdi32")
+        add_defines("_GLFW_WIN32=1")
+
+        add_linkdirs("thirdParty/opencv/x64/vc16/lib")
+        add_links("opencv_world4100")
+    else
+        -- linux: 用于 CI 中运行 --headless 批处理
+        add_defines("_GLFW_X11=1")
+        add_syslinks("GL", "X11", "pthread", "dl", "rt")
+        add_links("opencv_core", "opencv_imgproc", "opencv_imgcodecs")
+    end
+
+-- 共享内存帧读取程序, 用于测试 FixedCanvas2D 的共享内存发布 (shm-reader --self-test)
+target("shm-reader")
+    set_kind("binary")
+    add_files("tools/shm-reader.cpp")
+    add_files("tg/shm/*.cpp")
+    add_files("tg/utils.cpp")
+
+    if not is_plat("windows") then
+        add_syslinks("pthread", "rt")
+    end